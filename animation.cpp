@@ -0,0 +1,288 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "animation.hpp"
+#include "gifdecoder.hpp"
+#include "loader.hpp"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+typedef std::chrono::duration<double, std::milli> Ms;
+
+bool openGifSource(const std::string& path, FrameSource& src, std::string& err){
+    std::shared_ptr<GifDecoder> gif = std::make_shared<GifDecoder>();
+    if(!gif->open(path, err))
+        return false;
+
+    if(gif->frames() < 2)
+        return false;
+
+    src.w = gif->width();
+    src.h = gif->height();
+    src.frames = gif->frames();
+    src.plays = gif->plays();
+    src.next = [gif](unsigned char* out, int& delayMs, std::string& e){ return gif->next(out, delayMs, e); };
+    src.rewind = [gif](){ gif->rewind(); };
+    return true;
+}
+
+bool openSequenceSource(const std::vector<std::string>& paths, double fps, FrameSource& src,
+                        std::string& err){
+    if(paths.empty() || fps <= 0.0){
+        err = "Nothing to play";
+        return false;
+    }
+
+    // the first frame only gives the size here; it is decoded again when
+    // its turn comes
+    std::shared_ptr<Image> first = decodeFrame(paths[0], err);
+    if(!first)
+        return false;
+
+    int w = first->w, h = first->h;
+    int delayMs = std::max(1, (int)(1000.0 / fps + 0.5));
+    std::shared_ptr<size_t> index = std::make_shared<size_t>(0);
+    src.w = w;
+    src.h = h;
+    src.frames = (int)paths.size();
+    src.plays = 0;
+    src.rewind = [index](){ *index = 0; };
+    src.next = [paths, index, w, h, delayMs](unsigned char* out, int& delay, std::string&){
+        // unreadable or odd-sized files are passed over, not fatal
+        while(*index < paths.size()){
+            const std::string& path = paths[(*index)++];
+            std::string e;
+            std::shared_ptr<Image> img = decodeFrame(path, e);
+            if(!img){
+                std::cerr << e << "\n";
+                continue;
+            }
+            if(img->w != w || img->h != h){
+                std::cerr << "Skipping " << path << ": " << img->w << "x" << img->h
+                          << " in a " << w << "x" << h << " sequence\n";
+                continue;
+            }
+
+            const ImageLevel& lv = img->levels[0];
+            for(int y = 0; y < h; y++){
+                int row = img->topFirst ? h - 1 - y : y;
+                expandToRgba(lv.pixels + (size_t)row * lv.stride, img->channels, img->bgr,
+                             out + (size_t)y * w * 4, w);
+            }
+            delay = delayMs;
+            return true;
+        }
+        return false;
+    };
+    return true;
+}
+
+AnimationPlayer::~AnimationPlayer(){
+    stop();
+}
+
+void AnimationPlayer::start(FrameSourceOpener open, size_t budget){
+    stop();
+
+    head = count = 0;
+    stopping = false;
+    counters = Stats();
+    isPaused = staged = started = false;
+
+    running = true;
+    worker = std::thread([this, open, budget](){ run(open, budget); });
+}
+
+void AnimationPlayer::stop(){
+    if(worker.joinable()){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        space.notify_all();
+        worker.join();
+    }
+
+    running = false;
+    ring.clear();
+    head = count = 0;
+    stopping = false;
+}
+
+void AnimationPlayer::run(FrameSourceOpener open, size_t budget){
+    FrameSource src;
+    std::string openErr;
+    if(!open(src, openErr)){
+        if(!openErr.empty())
+            std::cerr << openErr << "\n";
+        return;
+    }
+
+    // a couple of frames at least so one can decode while one waits,
+    // more only while they fit in the budget
+    size_t frameBytes = std::max<size_t>((size_t)src.w * src.h * 4, 1);
+    size_t slots = std::min<size_t>(std::max<size_t>(budget / frameBytes, 2), 8);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ring.assign(std::min(slots, (size_t)std::max(src.frames, 2)), Slot());
+        counters.ringFrames = ring.size();
+    }
+
+    int plays = 0;
+    for(;;){
+        size_t slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            space.wait(lock, [this](){ return stopping || count < ring.size(); });
+            if(stopping)
+                return;
+            slot = (head + count) % ring.size();
+        }
+
+        // nobody else touches a slot outside [head, head + count)
+        Slot& s = ring[slot];
+        s.frame.w = src.w;
+        s.frame.h = src.h;
+        s.frame.pixels.resize((size_t)src.w * src.h * 4);
+
+        Clock::time_point t0 = Clock::now();
+        std::string err;
+        int delayMs = 0;
+        bool ok = src.next(s.frame.pixels.data(), delayMs, err);
+        if(!ok && err.empty()){
+            plays++;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                counters.loops = plays;
+                if(src.plays > 0 && plays >= src.plays)
+                    return;
+            }
+            src.rewind();
+            ok = src.next(s.frame.pixels.data(), delayMs, err);
+        }
+
+        if(!ok){
+            if(!err.empty())
+                std::cerr << err << "\n";
+            return;
+        }
+
+        double ms = Ms(Clock::now() - t0).count();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            s.delayMs = delayMs;
+            s.frame.submitted = t0;
+            count++;
+            counters.decoded++;
+            counters.decodeMs += ms;
+        }
+
+        if(notify)
+            notify();
+    }
+}
+
+void AnimationPlayer::setPaused(bool p){
+    if(p == isPaused)
+        return;
+
+    // the frame on screen keeps the rest of its time
+    if(p)
+        pausedAt = Clock::now();
+    else if(started)
+        due += Clock::now() - pausedAt;
+    isPaused = p;
+}
+
+bool AnimationPlayer::update(Clock::time_point now,
+                             const std::function<bool(const FrameStream::Frame&)>& upload){
+    if(!running || isPaused)
+        return false;
+
+    if(!staged){
+        std::unique_lock<std::mutex> lock(mutex);
+
+        // a frame whose whole time went by while the one after it is
+        // ready too would never be seen
+        while(started && count >= 2 &&
+              now >= due + std::chrono::duration_cast<Clock::duration>(Ms(ring[head].delayMs))){
+            due += std::chrono::duration_cast<Clock::duration>(Ms(ring[head].delayMs));
+            head = (head + 1) % ring.size();
+            count--;
+            counters.dropped++;
+            space.notify_one();
+        }
+
+        if(count == 0)
+            return false;
+
+        // the slot stays ours while it is copied out
+        Slot& s = ring[head];
+        lock.unlock();
+        bool ok = upload(s.frame);
+        lock.lock();
+
+        stagedDelayMs = s.delayMs;
+        head = (head + 1) % ring.size();
+        count--;
+        space.notify_one();
+        if(!ok)
+            return false;
+
+        staged = true;
+        if(!started){
+            started = true;
+            due = now;
+        }
+    }
+
+    if(now < due)
+        return false;
+
+    // the schedule is kept so timing does not drift, unless the frame is
+    // so late (a stall, a starved decoder) that catching up would mean
+    // dropping a burst of frames
+    double late = Ms(now - due).count();
+    Clock::duration delay = std::chrono::duration_cast<Clock::duration>(Ms(stagedDelayMs));
+    due = late > 250.0 ? now + delay : due + delay;
+    staged = false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.shown++;
+    if(late > lateMs){
+        counters.late++;
+        counters.maxLateMs = std::max(counters.maxLateMs, late);
+    }
+    return true;
+}
+
+double AnimationPlayer::secondsToNext(Clock::time_point now) const {
+    if(!running || isPaused || !staged)
+        return -1.0;
+
+    return std::max(0.0, std::chrono::duration<double>(due - now).count());
+}
+
+AnimationPlayer::Stats AnimationPlayer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
@@ -0,0 +1,137 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "stream.hpp"
+
+// Where an animation's frames come from, one at a time: next() writes
+// the next frame (RGBA8, rows bottom to top, w x h) and how long it
+// stays up, and returns false at the end (err empty) or on failure;
+// rewind() starts over. plays is how often to play it, 0 for forever.
+struct FrameSource{
+    int w = 0, h = 0;
+    int frames = 0;
+    int plays = 0;
+    std::function<bool(unsigned char* out, int& delayMs, std::string& err)> next;
+    std::function<void()> rewind;
+};
+
+// Fills src when it opens. Run on the player's worker thread, so reading
+// a large file does not hold up the render loop.
+typedef std::function<bool(FrameSource& src, std::string& err)> FrameSourceOpener;
+
+// An animated GIF, decoded frame by frame. False with err for a broken
+// file, with err empty for a still one (nothing to play).
+bool openGifSource(const std::string& path, FrameSource& src, std::string& err);
+// Still images shown one after another at fps, looping; ones not the
+// size of the first are skipped.
+bool openSequenceSource(const std::vector<std::string>& paths, double fps, FrameSource& src,
+                        std::string& err);
+
+// Plays a FrameSource. A worker thread decodes ahead into a ring of a
+// few frames bounded by a byte budget, so memory does not grow with the
+// length of the animation. The render thread uploads the next decoded
+// frame early into a back texture and flips to it when it is due, on a
+// schedule that does not drift; a frame whose time has wholly passed
+// while a later one is ready is dropped, one reaching the screen late
+// is counted.
+class AnimationPlayer{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Stats{
+        unsigned long shown = 0;
+        unsigned long late = 0;         // on screen more than lateMs after their time
+        unsigned long dropped = 0;      // skipped to catch up
+        unsigned long decoded = 0;
+        unsigned long loops = 0;
+        double maxLateMs = 0.0;
+        double decodeMs = 0.0;          // worker time in FrameSource::next
+        size_t ringFrames = 0;
+    };
+
+    static constexpr double lateMs = 8.0;
+
+    ~AnimationPlayer();
+
+    // Stops whatever played before, opens a new source and starts
+    // decoding it.
+    void start(FrameSourceOpener open, size_t budget);
+    void stop();
+    bool active() const { return running; }
+
+    // Called from the worker after each decoded frame.
+    void setNotify(std::function<void()> fn) { notify = std::move(fn); }
+
+    void setPaused(bool p);
+    bool paused() const { return isPaused; }
+
+    // Render thread, once per loop. Drops frames that are too late,
+    // passes the next one to upload (into a back texture) once, and
+    // returns true when that frame is due and should be flipped to.
+    bool update(Clock::time_point now, const std::function<bool(const FrameStream::Frame&)>& upload);
+
+    // Until the uploaded frame is due, for the event wait timeout; -1
+    // when there is none (the worker's notify wakes the loop instead).
+    double secondsToNext(Clock::time_point now) const;
+
+    Stats stats() const;
+
+private:
+    struct Slot{
+        FrameStream::Frame frame;
+        int delayMs = 0;
+    };
+
+    void run(FrameSourceOpener open, size_t budget);
+
+    std::thread worker;
+    std::function<void()> notify;
+    bool running = false;
+
+    // ring shared with the worker: slots [head, head + count) are decoded
+    mutable std::mutex mutex;
+    std::condition_variable space;
+    std::vector<Slot> ring;
+    size_t head = 0, count = 0;
+    bool stopping = false;
+    Stats counters;
+
+    // render thread only
+    bool isPaused = false;
+    bool staged = false;            // uploaded, waiting for its time
+    int stagedDelayMs = 0;
+    bool started = false;           // a frame went up; due follows on from it
+    Clock::time_point due;
+    Clock::time_point pausedAt;
+};
+
+#endif // ANIMATION_H
@@ -0,0 +1,205 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "batch.hpp"
+#include "image.hpp"
+#include "mipmap.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+#include "stb_image.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Bytes of decoded pixels the workers may hold between them. An image
+// larger than the whole budget still goes through, alone.
+class ByteBudget{
+public:
+    explicit ByteBudget(size_t limit): limit(limit) {}
+
+    void acquire(size_t n){
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&](){ return used == 0 || used + n <= limit; });
+        used += n;
+        peak = std::max(peak, used);
+    }
+
+    void release(size_t n){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            used -= n;
+        }
+        cv.notify_all();
+    }
+
+    size_t peakBytes(){
+        std::lock_guard<std::mutex> lock(mutex);
+        return peak;
+    }
+
+private:
+    size_t limit, used = 0, peak = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+struct Totals{
+    std::atomic<size_t> written{0}, failed{0};
+    std::atomic<size_t> bytesIn{0}, bytesOut{0}, pixelsIn{0};
+};
+
+bool writeImage(const std::string& path, const BatchOptions& opts, const ImageLevel& l){
+    const char* p = path.c_str();
+    if(opts.format == "png")
+        return stbi_write_png(p, l.w, l.h, 4, l.pixels, (int)l.stride) != 0;
+    if(opts.format == "bmp")
+        return stbi_write_bmp(p, l.w, l.h, 4, l.pixels) != 0;
+    if(opts.format == "tga")
+        return stbi_write_tga(p, l.w, l.h, 4, l.pixels) != 0;
+    return stbi_write_jpg(p, l.w, l.h, 4, l.pixels, opts.quality) != 0;
+}
+
+// Decode, halve in linear light down to under twice the target, finish
+// with a tent resize, encode.
+bool convert(const std::string& in, const std::string& out, const BatchOptions& opts,
+             ByteBudget& budget, Totals& totals){
+    int w, h, comp;
+    if(!stbi_info(in.c_str(), &w, &h, &comp)){
+        std::cerr << "Not an image: " << in << "\n";
+        return false;
+    }
+
+    int tw, th;
+    if(opts.scale > 0.0f){
+        tw = (int)std::lround(w * std::min(opts.scale, 1.0f));
+        th = (int)std::lround(h * std::min(opts.scale, 1.0f));
+    } else {
+        double f = std::min(1.0, (double)opts.size / std::max(w, h));
+        tw = (int)std::lround(w * f);
+        th = (int)std::lround(h * f);
+    }
+    tw = std::max(tw, 1);
+    th = std::max(th, 1);
+
+    // level 0, the halvings below it and the output
+    size_t need = (size_t)w * h * 4 * 4 / 3 + (size_t)tw * th * 4;
+    budget.acquire(need);
+
+    // rows top to bottom as the file stores them, which is also the
+    // order the writers take
+    bool ok = false;
+    unsigned char* data = stbi_load(in.c_str(), &w, &h, nullptr, 4);
+    if(data){
+        auto img = makeImage(data, w, h, 4, [data](){ stbi_image_free(data); });
+        buildThumbnail(*img, std::max(1, 2 * std::max(tw, th) - 1));
+
+        ImageLevel src = img->thumbnail, dst = src;
+        std::vector<unsigned char> resized;
+        if(src.w != tw || src.h != th){
+            resized.resize((size_t)tw * th * 4);
+            dst.w = tw;
+            dst.h = th;
+            dst.stride = (size_t)tw * 4;
+            dst.pixels = resized.data();
+            resizeLevel(src, dst, 4);
+        }
+
+        ok = writeImage(out, opts, dst);
+        if(ok){
+            std::error_code ec;
+            totals.bytesIn += (size_t)fs::file_size(in, ec);
+            totals.bytesOut += (size_t)fs::file_size(out, ec);
+            totals.pixelsIn += (size_t)w * h;
+        } else {
+            std::cerr << "Failed to write " << out << "\n";
+        }
+    } else {
+        std::cerr << "Failed to load image: " << in << "\n";
+    }
+
+    budget.release(need);
+    return ok;
+}
+
+} // namespace
+
+int runBatch(const std::vector<std::string>& files, const BatchOptions& opts){
+    static const char* formats[] = {"jpg", "png", "bmp", "tga"};
+    if(std::find(std::begin(formats), std::end(formats), opts.format) == std::end(formats)){
+        std::cerr << "Unknown output format: " << opts.format << "\n";
+        return 1;
+    }
+
+    std::error_code ec;
+    fs::create_directories(opts.outDir, ec);
+    if(!fs::is_directory(opts.outDir, ec)){
+        std::cerr << "Cannot create output directory " << opts.outDir << "\n";
+        return 1;
+    }
+
+    // one output per input; clashing names get -2, -3, ... in list order
+    std::vector<std::string> outputs;
+    std::map<std::string, int> seen;
+    for(const std::string &f : files){
+        std::string stem = fs::path(f).stem().string();
+        int n = ++seen[stem];
+        if(n > 1)
+            stem += "-" + std::to_string(n);
+        outputs.push_back((fs::path(opts.outDir) / (stem + "." + opts.format)).string());
+    }
+
+    ByteBudget budget(opts.memoryBudget);
+    Totals totals;
+    unsigned threads = opts.threads ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+    auto start = std::chrono::steady_clock::now();
+    parallelForStealing(files.size(), threads, [&](size_t i, unsigned){
+        if(convert(files[i], outputs[i], opts, budget, totals))
+            totals.written++;
+        else
+            totals.failed++;
+    });
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    s = std::max(s, 1e-6);
+
+    std::cout << "Batch: " << totals.written << " images written to " << opts.outDir;
+    if(totals.failed > 0)
+        std::cout << ", " << totals.failed << " failed";
+    std::cout << ", in " << s << " s on " << threads << " threads\n"
+              << "  " << totals.written / s << " images/s, "
+              << totals.bytesIn / s / (1 << 20) << " MB/s read, "
+              << totals.pixelsIn / s / 1e6 << " Mpix/s decoded, "
+              << (totals.bytesOut >> 10) << " KB written, peak "
+              << (budget.peakBytes() >> 20) << " MB decoded in flight\n";
+
+    return totals.failed > 0 ? 1 : 0;
+}
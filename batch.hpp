@@ -0,0 +1,44 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct BatchOptions{
+    std::string outDir = "thumbnails";
+    int size = 256;                 // longest side of each output, unless scale is set
+    float scale = 0.0f;             // or a fraction of the input size, at most 1
+    std::string format = "jpg";     // jpg, png, bmp or tga
+    int quality = 90;               // JPEG quality
+    unsigned threads = 0;           // 0 for one per hardware thread
+    size_t memoryBudget = size_t(1024) << 20; // decoded pixels in flight at once
+};
+
+// Writes a downscaled copy of every file into opts.outDir, never opening
+// a window, and prints images/s and MB/s at the end. Images are only
+// ever shrunk. Returns 0 if every file was written.
+int runBatch(const std::vector<std::string>& files, const BatchOptions& opts);
+
+#endif // BATCH_H
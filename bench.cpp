@@ -0,0 +1,367 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+// Offscreen benchmark: renders through an EGL context (Mesa llvmpipe is
+// enough) into a framebuffer object, replays a scripted pan/zoom session
+// through the same input, spring and drawing code as the viewer, and
+// checks the results against optional thresholds so regressions fail.
+
+#include "glimview.hpp"
+#include "glimviewoptions.hpp"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+// bench.script in the source tree, set by the build
+#ifndef GLIMVIEW_BENCH_SCRIPT
+#define GLIMVIEW_BENCH_SCRIPT "bench.script"
+#endif
+
+static const double frameDt = 1.0 / 60.0;
+// exit code when there is no GL to measure, which CTest reports as skipped
+static const int skipped = 77;
+static const int settleLimit = 600;
+// decoding and building the pyramid of the largest size on llvmpipe
+// takes a few seconds; a load that never finishes fails the run
+static const double startupLimitMs = 60000.0;
+
+struct Thresholds{
+    double maxP95 = 0.0, maxP99 = 0.0, maxFull = 0.0, minUpload = 0.0;
+};
+
+struct Result{
+    int size = 0;
+    GlimviewHeadlessStats stats;
+    std::vector<double> frameMs;
+};
+
+static unsigned char* pixels;
+
+static void freePixels(){
+    free(pixels);
+    pixels = nullptr;
+}
+
+static bool initEGL(){
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if(getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+
+    if(display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)){
+        std::cerr << "Failed to initialize EGL\n";
+        return false;
+    }
+
+    EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint count = 0;
+    eglChooseConfig(display, configAttribs, &config, 1, &count);
+    eglBindAPI(EGL_OPENGL_API);
+
+    EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    EGLContext context = eglCreateContext(display, count ? config : (EGLConfig)0,
+                                          EGL_NO_CONTEXT, contextAttribs);
+    if(context == EGL_NO_CONTEXT ||
+       !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)){
+        std::cerr << "Failed to create an offscreen GL 3.3 context\n";
+        return false;
+    }
+
+    if(!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)){
+        std::cerr << "Failed to init GLAD\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Smooth gradients with a fine checkerboard on top, so every mip level
+// has content and nothing compresses or caches trivially.
+static unsigned char* makeSynthetic(int w, int h){
+    unsigned char* data = (unsigned char*)malloc((size_t)w * h * 4);
+    for(int y = 0; y < h; y++){
+        unsigned char* row = data + (size_t)y * w * 4;
+        for(int x = 0; x < w; x++){
+            bool check = ((x >> 3) ^ (y >> 3)) & 1;
+            row[x * 4 + 0] = (unsigned char)(x * 255 / w);
+            row[x * 4 + 1] = (unsigned char)(y * 255 / h);
+            row[x * 4 + 2] = check ? 200 : 40;
+            row[x * 4 + 3] = 255;
+        }
+    }
+
+    return data;
+}
+
+static double timedFrame(std::vector<double>* out){
+    auto t0 = Clock::now();
+    glimviewHeadlessFrame(frameDt);
+    glFinish();
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    if(out)
+        out->push_back(ms);
+
+    return ms;
+}
+
+static void settle(std::vector<double>& out){
+    for(int i = 0; i < settleLimit; i++){
+        GlimviewHeadlessStats st = glimviewHeadlessStats();
+        if(st.settled && !st.tilesPending)
+            return;
+
+        timedFrame(&out);
+    }
+}
+
+static bool runScript(const std::string& script, std::vector<double>& out){
+    std::istringstream in(script);
+    std::string line;
+    int lineNo = 0;
+    while(std::getline(in, line)){
+        lineNo++;
+        std::istringstream ls(line);
+        std::string cmd;
+        if(!(ls >> cmd) || cmd[0] == '#')
+            continue;
+
+        if(cmd == "frames"){
+            int n = 0;
+            ls >> n;
+            for(int i = 0; i < n; i++)
+                timedFrame(&out);
+        } else if(cmd == "settle"){
+            settle(out);
+        } else if(cmd == "scroll"){
+            double x, y, dy;
+            ls >> x >> y >> dy;
+            glimviewHeadlessCursor(x, y);
+            glimviewHeadlessScroll(x, y, dy);
+            timedFrame(&out);
+        } else if(cmd == "drag"){
+            double x0, y0, x1, y1;
+            int n = 1;
+            ls >> x0 >> y0 >> x1 >> y1 >> n;
+            n = std::max(n, 1);
+            glimviewHeadlessCursor(x0, y0);
+            glimviewHeadlessButton(1, x0, y0);
+            for(int i = 1; i <= n; i++){
+                glimviewHeadlessCursor(x0 + (x1 - x0) * i / n, y0 + (y1 - y0) * i / n);
+                timedFrame(&out);
+            }
+            glimviewHeadlessButton(0, x1, y1);
+        } else {
+            std::cerr << "Script line " << lineNo << ": unknown command '" << cmd << "'\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static double percentile(std::vector<double> v, double p){
+    if(v.empty())
+        return 0.0;
+
+    std::sort(v.begin(), v.end());
+    size_t i = (size_t)std::min<double>(v.size() - 1, p * (v.size() - 1) + 0.5);
+    return v[i];
+}
+
+static void usage(const char* argv0){
+    std::cout << "Usage: " << argv0 << " [options]\n"
+              << "Options:\n"
+              << "  --script FILE        input script (default: the source tree's bench.script)\n"
+              << "  --sizes A,B,...      square synthetic image sizes (default 1024,4096,8192)\n"
+              << "  --window WxH         framebuffer size (default 1200x800)\n"
+              << "  --compress MODE      tile format: none, bc1, bc7 or auto\n"
+              << "  --max-p95 MS         fail if the 95th percentile frame time exceeds MS\n"
+              << "  --max-p99 MS         fail if the 99th percentile frame time exceeds MS\n"
+              << "  --max-full MS        fail if time to full image exceeds MS\n"
+              << "  --min-upload MBPS    fail if tile upload throughput is below MBPS\n";
+}
+
+int main(int argc, char** argv){
+    std::string scriptPath = GLIMVIEW_BENCH_SCRIPT;
+    std::vector<int> sizes = {1024, 4096, 8192};
+    int winW = 1200, winH = 800;
+    Thresholds limits;
+    GlimviewOptions opts;
+
+    for(int i = 1; i < argc; i++){
+        if(!strcmp(argv[i], "--script") && i + 1 < argc){
+            scriptPath = argv[++i];
+        } else if(!strcmp(argv[i], "--sizes") && i + 1 < argc){
+            sizes.clear();
+            std::stringstream ss(argv[++i]);
+            std::string item;
+            while(std::getline(ss, item, ','))
+                sizes.push_back(atoi(item.c_str()));
+        } else if(!strcmp(argv[i], "--window") && i + 1 < argc){
+            sscanf(argv[++i], "%dx%d", &winW, &winH);
+        } else if(!strcmp(argv[i], "--compress") && i + 1 < argc){
+            if(!parseTextureCompression(argv[++i], opts.compression)){
+                usage(argv[0]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "--max-p95") && i + 1 < argc){
+            limits.maxP95 = atof(argv[++i]);
+        } else if(!strcmp(argv[i], "--max-p99") && i + 1 < argc){
+            limits.maxP99 = atof(argv[++i]);
+        } else if(!strcmp(argv[i], "--max-full") && i + 1 < argc){
+            limits.maxFull = atof(argv[++i]);
+        } else if(!strcmp(argv[i], "--min-upload") && i + 1 < argc){
+            limits.minUpload = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::ifstream f(scriptPath);
+    if(!f){
+        std::cerr << "Cannot open script: " << scriptPath << "\n";
+        return 1;
+    }
+
+    std::stringstream ss;
+    ss << f.rdbuf();
+    std::string script = ss.str();
+
+    if(!initEGL())
+        return skipped;
+
+    glimviewSetOptions(opts);
+
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << "\n";
+
+    GLuint fbo, color;
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, winW, winH);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+
+    std::vector<Result> results;
+    bool ok = true;
+    for(int size : sizes){
+        Result r;
+        r.size = size;
+
+        glimviewHeadlessInit(winW, winH);
+        pixels = makeSynthetic(size, size);
+        freeData(freePixels);
+        glimviewUpdateImage(pixels, size, size);
+
+        // startup: blank frames until the image is decoded, then until
+        // every visible tile is resident
+        auto start = Clock::now();
+        for(;;){
+            timedFrame(nullptr);
+            GlimviewHeadlessStats st = glimviewHeadlessStats();
+            if(st.hasImage && !st.tilesPending)
+                break;
+
+            if(std::chrono::duration<double, std::milli>(Clock::now() - start).count() > startupLimitMs){
+                std::cerr << size << "x" << size << ": image not resident after "
+                          << startupLimitMs / 1000.0 << " s (" << (st.hasImage ? "tiles pending" : "not loaded")
+                          << ")\n";
+                glimviewHeadlessShutdown();
+                glDeleteFramebuffers(1, &fbo);
+                glDeleteRenderbuffers(1, &color);
+                return 1;
+            }
+        }
+
+        ok = runScript(script, r.frameMs) && ok;
+        r.stats = glimviewHeadlessStats();
+        glimviewHeadlessShutdown();
+        results.push_back(r);
+    }
+
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &color);
+
+    printf("\n%-12s %9s %9s %9s %7s %8s %8s %8s %8s %10s\n", "image", "attach", "first",
+           "full", "frames", "p50", "p95", "p99", "max", "upload");
+    printf("%-12s %9s %9s %9s %7s %8s %8s %8s %8s %10s\n", "", "ms", "ms", "ms", "",
+           "ms", "ms", "ms", "ms", "MB/s");
+    for(const Result &r : results){
+        const GlimviewHeadlessStats &st = r.stats;
+        double p95 = percentile(r.frameMs, 0.95), p99 = percentile(r.frameMs, 0.99);
+        double upload = st.uploadMs > 0.0 ? st.bytesUploaded / 1048576.0 / (st.uploadMs / 1000.0) : 0.0;
+        std::string name = std::to_string(r.size) + "x" + std::to_string(r.size);
+
+        printf("%-12s %9.1f %9.1f %9.1f %7zu %8.2f %8.2f %8.2f %8.2f %10.1f\n", name.c_str(),
+               st.attachMs, st.firstPixelMs, st.fullImageMs, r.frameMs.size(),
+               percentile(r.frameMs, 0.5), p95, p99, percentile(r.frameMs, 1.0), upload);
+
+        if(limits.maxP95 > 0.0 && p95 > limits.maxP95){
+            printf("FAIL %s: p95 %.2f ms > %.2f ms\n", name.c_str(), p95, limits.maxP95);
+            ok = false;
+        }
+
+        if(limits.maxP99 > 0.0 && p99 > limits.maxP99){
+            printf("FAIL %s: p99 %.2f ms > %.2f ms\n", name.c_str(), p99, limits.maxP99);
+            ok = false;
+        }
+
+        if(limits.maxFull > 0.0 && st.fullImageMs > limits.maxFull){
+            printf("FAIL %s: full image %.1f ms > %.1f ms\n", name.c_str(), st.fullImageMs, limits.maxFull);
+            ok = false;
+        }
+
+        if(limits.minUpload > 0.0 && upload < limits.minUpload){
+            printf("FAIL %s: upload %.1f MB/s < %.1f MB/s\n", name.c_str(), upload, limits.minUpload);
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,465 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "contactsheet.hpp"
+#include "loader.hpp"
+#include "mipmap.hpp"
+#include "shader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+static const char* sheet_vs = R"(
+#version 330 core
+layout(location=0) in vec2 aPos;
+layout(location=1) in vec4 aRect;       // thumbnail in sheet pixels
+layout(location=2) in vec3 aLayer;      // uv extent, atlas layer
+uniform mat4 uProj;
+uniform vec2 uPan;
+out vec2 vUV;
+flat out float vLayer;
+void main(){
+    gl_Position = uProj * vec4(aRect.xy + aPos * aRect.zw + uPan, 0.0, 1.0);
+    vUV = aPos * aLayer.xy;
+    vLayer = aLayer.z;
+}
+)";
+
+// layer -1 is a thumbnail still on its way, -2 one that failed to decode
+static const char* sheet_fs = R"(
+#version 330 core
+in vec2 vUV;
+flat in float vLayer;
+out vec4 FragColor;
+uniform sampler2DArray uAtlas;
+void main(){
+    if(vLayer < -1.5)
+        FragColor = vec4(0.35, 0.12, 0.12, 1.0);
+    else if(vLayer < 0.0)
+        FragColor = vec4(0.18, 0.18, 0.18, 1.0);
+    else
+        FragColor = texture(uAtlas, vec3(vUV, vLayer));
+}
+)";
+
+static const int floatsPerInstance = 7;
+
+ContactSheet::~ContactSheet(){
+    pool.clear();
+}
+
+void ContactSheet::init(){
+    GLuint vs = compileShader(GL_VERTEX_SHADER, sheet_vs);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, sheet_fs);
+    program = linkProgram(vs, fs);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    locProj = glGetUniformLocation(program, "uProj");
+    locPan = glGetUniformLocation(program, "uPan");
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uAtlas"), 0);
+
+    // a layer with its mips takes 4/3 of the base level
+    GLint maxLayers = 256;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    size_t layerBytes = (size_t)thumbSize * thumbSize * 4 * 4 / 3;
+    layers = (int)std::min<size_t>(std::max<size_t>(budget / layerBytes, 64), (size_t)maxLayers);
+}
+
+void ContactSheet::destroy(){
+    glDeleteProgram(program);
+    glDeleteTextures(1, &atlas);
+    program = atlas = 0;
+    layers = 0;
+    slots.clear();
+    std::fill(layerOf.begin(), layerOf.end(), -1);
+    lastWanted.clear();
+}
+
+void ContactSheet::setFiles(const std::vector<std::string>& f){
+    // a decode of the old list still running is dropped when it finishes
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pool.clear();
+        queued.clear();
+        done.clear();
+        files = f;
+    }
+
+    layerOf.assign(files.size(), -1);
+    failedFile.assign(files.size(), 0);
+    wantedIn.assign(files.size(), 0);
+    for(Layer& s : slots)
+        s = Layer();
+    wanted.clear();
+    lastWanted.clear();
+}
+
+void ContactSheet::createView(GLuint quadVBO, GLuint quadEBO, GLuint& vao, GLuint& instances){
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &instances);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
+
+    GLsizei stride = sizeof(float) * floatsPerInstance;
+    glBindBuffer(GL_ARRAY_BUFFER, instances);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 4));
+    glVertexAttribDivisor(2, 1);
+    glBindVertexArray(0);
+}
+
+void ContactSheet::destroyView(GLuint& vao, GLuint& instances){
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &instances);
+    vao = instances = 0;
+}
+
+ContactSheet::Layout ContactSheet::layout(int viewW, int viewH, float cell) const {
+    Layout l;
+    l.count = size();
+    l.cell = std::min(std::max(cell, 48.0f), 2.0f * thumbSize);
+
+    // every cell on screen needs its own layer, with room left to prefetch
+    auto onScreen = [&](float c){
+        return (int)std::ceil(viewW / c) * ((int)std::ceil(viewH / c) + 1);
+    };
+    while(layers > 0 && onScreen(l.cell) > layers / 2)
+        l.cell *= 1.1f;
+
+    l.cols = std::max(1, (int)(viewW / l.cell));
+    l.rows = (l.count + l.cols - 1) / l.cols;
+    return l;
+}
+
+int ContactSheet::cellAt(const Layout& l, float x, float y) const {
+    if(x < 0.0f || y < 0.0f)
+        return -1;
+
+    int col = (int)(x / l.cell);
+    int row = l.rows - 1 - (int)(y / l.cell);
+    if(col >= l.cols || row < 0)
+        return -1;
+
+    int i = row * l.cols + col;
+    return i < l.count ? i : -1;
+}
+
+void ContactSheet::cellOrigin(const Layout& l, int i, float& x, float& y) const {
+    x = (i % l.cols) * l.cell;
+    y = (l.rows - 1 - i / l.cols) * l.cell;
+}
+
+// Row 0 is at the top of the sheet; row r covers sheet y
+// [(rows - 1 - r) * cell, (rows - r) * cell).
+void ContactSheet::visibleRange(const Layout& l, float panY, int viewH, int& first, int& last) const {
+    int r0 = (int)std::floor(l.rows - 1 - (viewH - panY) / l.cell) + 1;
+    int r1 = (int)std::ceil(l.rows + panY / l.cell);
+    r0 = std::min(std::max(r0, 0), l.rows);
+    r1 = std::min(std::max(r1, r0), l.rows);
+    first = r0 * l.cols;
+    last = std::min(r1 * l.cols, l.count);
+}
+
+void ContactSheet::beginFrame(){
+    frameNo++;
+    wanted.clear();
+}
+
+void ContactSheet::want(const Layout& l, float panY, int viewH){
+    int first, last;
+    visibleRange(l, panY, viewH, first, last);
+
+    auto add = [&](int i){
+        if(i < 0 || i >= l.count || wantedIn[i] == frameNo || (int)wanted.size() >= layers)
+            return;
+
+        wantedIn[i] = frameNo;
+        wanted.push_back(i);
+        if(layerOf[i] >= 0)
+            slots[layerOf[i]].frame = frameNo;
+    };
+
+    // what is on screen top to bottom, then a screen's worth of rows
+    // either side, nearest first
+    for(int i = first; i < last; i++)
+        add(i);
+
+    int span = std::max(last - first, l.cols);
+    for(int d = 0; d < span; d++){
+        add(last + d);
+        add(first - 1 - d);
+    }
+}
+
+void ContactSheet::schedule(){
+    if(wanted == lastWanted)
+        return;
+
+    lastWanted = wanted;
+    std::lock_guard<std::mutex> lock(mutex);
+    pool.clear();
+    queued.clear();
+
+    std::vector<bool> ready(files.size(), false);
+    for(const auto &t : done)
+        ready[t->index] = true;
+
+    for(int i : wanted){
+        if(layerOf[i] >= 0 || failedFile[i] || ready[i] || inFlight.count(i))
+            continue;
+
+        queued.insert(i);
+        std::string path = files[i];
+        pool.submit([this, i, path](){ decode(i, path); });
+    }
+}
+
+void ContactSheet::decode(int index, const std::string& path){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.erase(index);
+        inFlight.insert(index);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<Thumb> t(new Thumb);
+    t->index = index;
+
+    std::string err;
+    std::shared_ptr<Image> img = decodeThumbnail(path, thumbSize, err);
+    std::vector<unsigned char> upright;
+    if(!img){
+        t->failed = true;
+    } else {
+        // the thumbnail, expanded to RGBA and turned upright, and its
+        // mips, each copied into a buffer with the last column and row
+        // repeated once where the layer has room
+        ImageLevel src = orientedRgba(*img, img->thumbnail, upright);
+        t->w = src.w;
+        t->h = src.h;
+        for(int side = thumbSize; ; side /= 2){
+            ImageLevel lv;
+            lv.w = std::min(src.w + 1, side);
+            lv.h = std::min(src.h + 1, side);
+            lv.stride = (size_t)lv.w * 4;
+            t->storage.emplace_back(new unsigned char[lv.stride * lv.h]);
+            lv.pixels = t->storage.back().get();
+            for(int y = 0; y < lv.h; y++){
+                const unsigned char* s = src.pixels + std::min(y, src.h - 1) * src.stride;
+                unsigned char* d = lv.pixels + y * lv.stride;
+                memcpy(d, s, (size_t)src.w * 4);
+                if(lv.w > src.w)
+                    memcpy(d + (size_t)src.w * 4, s + (size_t)(src.w - 1) * 4, 4);
+            }
+            t->levels.push_back(lv);
+
+            if(side == 1)
+                break;
+
+            ImageLevel dst;
+            dst.w = std::max(1, (src.w + 1) / 2);
+            dst.h = std::max(1, (src.h + 1) / 2);
+            dst.stride = (size_t)dst.w * 4;
+            t->storage.emplace_back(new unsigned char[dst.stride * dst.h]);
+            dst.pixels = t->storage.back().get();
+            downsampleLevel(src, dst, 4, MipFilter::Box);
+            src = dst;
+        }
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight.erase(index);
+        decodeMs += ms;
+        if(t->failed)
+            failedCount++;
+        else
+            decoded++;
+
+        // the list may have been replaced while this ran
+        if(index < (int)files.size() && files[index] == path)
+            done.push_back(std::move(t));
+    }
+
+    if(void (*fn)() = notify)
+        fn();
+}
+
+bool ContactSheet::allocAtlas(){
+    if(atlas)
+        return true;
+    if(!layers)
+        return false;
+
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, atlas);
+    int levels = 0;
+    for(int side = thumbSize; side >= 1; side /= 2)
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, levels++, GL_RGBA8, side, side, layers, 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, nullptr);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    slots.assign(layers, Layer());
+    return true;
+}
+
+// A free layer, or the one drawn longest ago that nothing wants now.
+int ContactSheet::takeLayer(){
+    int best = -1;
+    for(int i = 0; i < (int)slots.size(); i++){
+        if(slots[i].file < 0)
+            return i;
+        if(slots[i].frame != frameNo && (best < 0 || slots[i].frame < slots[best].frame))
+            best = i;
+    }
+
+    if(best >= 0){
+        layerOf[slots[best].file] = -1;
+        slots[best].file = -1;
+        evictions++;
+    }
+
+    return best;
+}
+
+bool ContactSheet::upload(){
+    std::vector<std::unique_ptr<Thumb>> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t n = std::min(done.size(), (size_t)maxUploadsPerFrame);
+        for(size_t i = 0; i < n; i++)
+            batch.push_back(std::move(done[i]));
+        done.erase(done.begin(), done.begin() + n);
+    }
+
+    if(batch.empty() || !allocAtlas())
+        return false;
+
+    // a few hundred KB each, uploaded directly like the minimap
+    glBindTexture(GL_TEXTURE_2D_ARRAY, atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for(const auto &t : batch){
+        if(t->failed){
+            failedFile[t->index] = 1;
+            continue;
+        }
+
+        if(layerOf[t->index] >= 0)
+            continue;
+
+        int layer = takeLayer();
+        if(layer < 0){
+            // every layer is on screen; ask again once that changes
+            lastWanted.clear();
+            continue;
+        }
+
+        for(size_t l = 0; l < t->levels.size(); l++){
+            const ImageLevel& lv = t->levels[l];
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)l, 0, 0, layer, lv.w, lv.h, 1, GL_RGBA,
+                            GL_UNSIGNED_BYTE, lv.pixels);
+        }
+
+        slots[layer].file = t->index;
+        slots[layer].w = t->w;
+        slots[layer].h = t->h;
+        slots[layer].frame = frameNo;
+        layerOf[t->index] = layer;
+        uploads++;
+    }
+
+    return true;
+}
+
+bool ContactSheet::pending(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return !done.empty();
+}
+
+void ContactSheet::draw(const Layout& l, float panX, float panY, int viewH, const float* proj,
+                        GLuint vao, GLuint instances){
+    int first, last;
+    visibleRange(l, panY, viewH, first, last);
+    if(first >= last)
+        return;
+
+    // thumbnails keep their aspect, centred in the cell
+    float avail = l.cell - 2.0f * padding;
+    scratch.clear();
+    for(int i = first; i < last; i++){
+        float x, y;
+        cellOrigin(l, i, x, y);
+
+        int layer = layerOf[i];
+        float w = avail, h = avail, u = 0.0f, v = 0.0f, z = failedFile[i] ? -2.0f : -1.0f;
+        if(layer >= 0){
+            const Layer& s = slots[layer];
+            float k = std::min(avail / s.w, avail / s.h);
+            w = s.w * k;
+            h = s.h * k;
+            u = (float)s.w / thumbSize;
+            v = (float)s.h / thumbSize;
+            z = (float)layer;
+            slots[layer].frame = frameNo;
+        }
+
+        float cell[floatsPerInstance] = {
+            x + (l.cell - w) * 0.5f, y + (l.cell - h) * 0.5f, w, h, u, v, z
+        };
+        scratch.insert(scratch.end(), cell, cell + floatsPerInstance);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instances);
+    glBufferData(GL_ARRAY_BUFFER, scratch.size() * sizeof(float), scratch.data(), GL_STREAM_DRAW);
+
+    glUseProgram(program);
+    glUniformMatrix4fv(locProj, 1, GL_FALSE, proj);
+    glUniform2f(locPan, panX, panY);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, atlas);
+    glBindVertexArray(vao);
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, last - first);
+}
+
+ContactSheet::Stats ContactSheet::stats(){
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats st;
+    st.decoded = decoded;
+    st.failed = failedCount;
+    st.uploads = uploads;
+    st.evictions = evictions;
+    st.decodeMs = decodeMs;
+    return st;
+}
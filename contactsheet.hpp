@@ -0,0 +1,158 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef CONTACTSHEET_H
+#define CONTACTSHEET_H
+
+#include <glad/glad.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "image.hpp"
+#include "minimap.hpp"
+#include "threadpool.hpp"
+
+// Thumbnails of every file in the playlist laid out in a grid. Only the
+// rows around what some view shows are decoded, on a pool of worker
+// threads, nearest first. The thumbnails live in the layers of one
+// GL_TEXTURE_2D_ARRAY, so every visible cell goes out in a single
+// instanced draw. Layers are recycled least recently drawn first once
+// the atlas is full.
+//
+// The atlas, its program and the decode pool are shared by all views;
+// each view (GL context) has a VAO and an instance buffer of its own
+// from createView().
+class ContactSheet{
+public:
+    static constexpr int thumbSize = Minimap::thumbnailSize;   // atlas layer side
+    static constexpr int maxUploadsPerFrame = 16;
+    static constexpr float padding = 4.0f;     // between a cell and its thumbnail
+
+    struct Layout{
+        int count = 0;
+        int cols = 1, rows = 0;
+        float cell = 160.0f;
+        float width() const { return cols * cell; }
+        float height() const { return rows * cell; }
+    };
+
+    struct Stats{
+        unsigned decoded = 0, failed = 0;
+        unsigned uploads = 0, evictions = 0;
+        double decodeMs = 0.0;      // CPU time on the decode threads
+    };
+
+    ~ContactSheet();
+
+    void init();
+    void destroy();
+    // VRAM for the atlas, taken when the grid is first shown.
+    void setBudget(size_t bytes) { budget = bytes; }
+    // Called from a decode thread whenever a thumbnail is ready.
+    void setNotify(void (*fn)()) { notify = fn; }
+    void setFiles(const std::vector<std::string>& files);
+    int size() const { return (int)files.size(); }
+
+    void createView(GLuint quadVBO, GLuint quadEBO, GLuint& vao, GLuint& instances);
+    void destroyView(GLuint& vao, GLuint& instances);
+
+    // Cells of cell pixels filling rows viewW wide. The smallest cell
+    // allowed keeps a viewW x viewH screen of them within half the atlas.
+    Layout layout(int viewW, int viewH, float cell) const;
+    // Index of the cell under p (sheet coordinates, origin at the bottom
+    // left of the last row), -1 if none.
+    int cellAt(const Layout& l, float x, float y) const;
+    // Bottom left corner of cell i in sheet coordinates.
+    void cellOrigin(const Layout& l, int i, float& x, float& y) const;
+
+    // Wanted files are collected afresh on every loop iteration: call
+    // beginFrame(), want() for every view on screen, then schedule().
+    void beginFrame();
+    // Marks the cells of a viewH tall view whose sheet origin sits at
+    // panY as wanted, plus a screen of prefetch above and below.
+    void want(const Layout& l, float panY, int viewH);
+    void schedule();
+
+    // Moves finished thumbnails into the atlas; true if any arrived.
+    bool upload();
+    // Finished thumbnails are waiting for upload().
+    bool pending();
+
+    // Draws the visible cells, the sheet offset by (panX, panY). Binds
+    // its own program.
+    void draw(const Layout& l, float panX, float panY, int viewH, const float* proj,
+              GLuint vao, GLuint instances);
+
+    Stats stats();
+
+private:
+    // A decoded thumbnail with its mips, each padded by one replicated
+    // column and row where the layer has room, so filtering at the edge
+    // never reads a previous occupant of the layer.
+    struct Thumb{
+        int index = 0;
+        bool failed = false;
+        int w = 0, h = 0;
+        std::vector<ImageLevel> levels;
+        std::vector<std::unique_ptr<unsigned char[]>> storage;
+    };
+
+    void decode(int index, const std::string& path);
+    void visibleRange(const Layout& l, float panY, int viewH, int& first, int& last) const;
+    bool allocAtlas();
+    int takeLayer();
+
+    std::vector<std::string> files;     // written under the mutex
+    size_t budget = size_t(256) << 20;
+    void (*notify)() = nullptr;
+
+    // render thread
+    GLuint program = 0, atlas = 0;
+    GLint locProj = -1, locPan = -1;
+    int layers = 0;
+    std::vector<int> layerOf;           // per file, -1 when not in the atlas
+    std::vector<unsigned char> failedFile;
+    struct Layer{
+        int file = -1;
+        int w = 0, h = 0;
+        unsigned frame = 0;
+    };
+    std::vector<Layer> slots;
+    unsigned frameNo = 0;
+    std::vector<int> wanted, lastWanted;
+    std::vector<unsigned> wantedIn;     // per file, frameNo of the last want()
+    std::vector<float> scratch;
+    unsigned uploads = 0, evictions = 0;
+
+    // shared with the decode threads
+    std::mutex mutex;
+    std::set<int> queued, inFlight;
+    std::vector<std::unique_ptr<Thumb>> done;
+    unsigned decoded = 0, failedCount = 0;
+    double decodeMs = 0.0;
+
+    // last so its workers are joined before the state they touch goes away
+    ThreadPool pool;
+};
+
+#endif // CONTACTSHEET_H
@@ -0,0 +1,459 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "diskcache.hpp"
+#include "mipmap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char magic[8] = {'G', 'L', 'I', 'M', 'P', 'Y', 'R', 0};
+const uint32_t formatVersion = 2;
+const uint64_t pageSize = 4096;
+
+// File layout: header, levels + 1 entries (the last is the thumbnail),
+// then the pixel rows of every entry, each starting on a page boundary.
+struct CacheHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    uint32_t w, h;
+    uint32_t levels;
+    uint32_t opaque;
+    uint32_t topFirst;
+    int32_t orientation[4];
+};
+
+struct CacheLevel{
+    uint32_t w, h;
+    uint64_t stride;
+    uint64_t offset;
+};
+
+uint64_t alignPage(uint64_t v){
+    return (v + pageSize - 1) & ~(pageSize - 1);
+}
+
+bool writeEntry(const std::string& file, const Image& img){
+    std::vector<ImageLevel> levels = img.levels;
+    levels.push_back(img.thumbnail);
+
+    CacheHeader hdr = {};
+    memcpy(hdr.magic, magic, sizeof(magic));
+    hdr.version = formatVersion;
+    hdr.channels = img.channels;
+    hdr.w = img.w;
+    hdr.h = img.h;
+    hdr.levels = (uint32_t)img.levels.size();
+    hdr.opaque = img.opaque;
+    hdr.topFirst = img.topFirst;
+    memcpy(hdr.orientation, img.orientation.m, sizeof(hdr.orientation));
+
+    std::vector<CacheLevel> entries;
+    uint64_t offset = alignPage(sizeof(hdr) + levels.size() * sizeof(CacheLevel));
+    for(const ImageLevel& lv : levels){
+        CacheLevel e;
+        e.w = lv.w;
+        e.h = lv.h;
+        e.stride = (uint64_t)lv.w * img.channels;
+        e.offset = offset;
+        offset = alignPage(offset + e.stride * e.h);
+        entries.push_back(e);
+    }
+
+    std::error_code ec;
+    fs::create_directories(fs::path(file).parent_path(), ec);
+
+    // readers only ever see complete entries
+    std::string tmp = file + ".tmp" + std::to_string((unsigned long)getpid());
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if(!f)
+        return false;
+
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+              fwrite(entries.data(), sizeof(CacheLevel), entries.size(), f) == entries.size();
+    for(size_t i = 0; ok && i < levels.size(); i++){
+        ok = fseek(f, (long)entries[i].offset, SEEK_SET) == 0;
+        for(int y = 0; ok && y < levels[i].h; y++)
+            ok = fwrite(levels[i].pixels + y * levels[i].stride, entries[i].stride, 1, f) == 1;
+    }
+
+    // pad the last entry out to its page so the mapping covers it
+    ok = ok && fseek(f, (long)offset - 1, SEEK_SET) == 0 && fputc(0, f) != EOF;
+    ok = fclose(f) == 0 && ok;
+    if(ok)
+        ok = rename(tmp.c_str(), file.c_str()) == 0;
+    if(!ok)
+        remove(tmp.c_str());
+
+    return ok;
+}
+
+#ifndef _WIN32
+std::shared_ptr<Image> mapEntry(const std::string& file){
+    int fd = open(file.c_str(), O_RDONLY);
+    if(fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CacheHeader)){
+        close(fd);
+        return nullptr;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return nullptr;
+
+    unsigned char* base = (unsigned char*)map;
+    const CacheHeader* hdr = (const CacheHeader*)base;
+    size_t tableEnd = sizeof(CacheHeader) + (size_t)(hdr->levels + 1) * sizeof(CacheLevel);
+    if(memcmp(hdr->magic, magic, sizeof(magic)) || hdr->version != formatVersion ||
+       hdr->channels < 1 || hdr->channels > 4 || hdr->w == 0 || hdr->h == 0 ||
+       hdr->w > INT_MAX || hdr->h > INT_MAX ||
+       hdr->levels == 0 || hdr->levels > 32 || tableEnd > size){
+        munmap(map, size);
+        return nullptr;
+    }
+
+    auto img = std::make_shared<Image>();
+    img->w = hdr->w;
+    img->h = hdr->h;
+    img->channels = hdr->channels;
+    img->opaque = hdr->opaque != 0;
+    img->topFirst = hdr->topFirst != 0;
+    memcpy(img->orientation.m, hdr->orientation, sizeof(hdr->orientation));
+    img->readOnly = true;
+    img->release = [map, size](){ munmap(map, size); };
+
+    // every level is the one before halved, rounding up, as buildPyramid
+    // makes them; the thumbnail is no larger than the last level. The
+    // table follows the 52-byte header, so entries are copied out rather
+    // than read in place unaligned.
+    uint32_t w = hdr->w, h = hdr->h;
+    for(uint32_t i = 0; i <= hdr->levels; i++){
+        CacheLevel e;
+        memcpy(&e, base + sizeof(CacheHeader) + i * sizeof(CacheLevel), sizeof(e));
+        bool sized = i < hdr->levels ? e.w == w && e.h == h : e.w >= 1 && e.h >= 1 && e.w <= w && e.h <= h;
+        if(!sized || e.stride < (uint64_t)e.w * hdr->channels || e.stride > size ||
+           e.offset > size || e.stride * e.h > size - e.offset)
+            return nullptr;
+        if(i + 1 < hdr->levels){
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+        }
+
+        ImageLevel lv;
+        lv.w = e.w;
+        lv.h = e.h;
+        lv.stride = e.stride;
+        lv.pixels = base + e.offset;
+        if(i < hdr->levels)
+            img->levels.push_back(lv);
+        else
+            img->thumbnail = lv;
+    }
+
+    return img;
+}
+
+uint64_t hashFile(const std::string& path, bool& ok){
+    ok = false;
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return 0;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0){
+        close(fd);
+        return 0;
+    }
+
+    void* map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return 0;
+
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    uint64_t h = hash64(map, (size_t)st.st_size);
+    munmap(map, (size_t)st.st_size);
+    ok = true;
+    return h;
+}
+#endif
+
+} // namespace
+
+DiskCache& diskCache(){
+    // never destroyed, loader threads may still store while exiting
+    static DiskCache* cache = new DiskCache;
+    return *cache;
+}
+
+void DiskCache::configure(const std::string& d, size_t l){
+    std::string resolved = d;
+    if(resolved.empty()){
+        if(const char* xdg = getenv("XDG_CACHE_HOME"))
+            resolved = std::string(xdg) + "/glimview";
+        else if(const char* home = getenv("HOME"))
+            resolved = std::string(home) + "/.cache/glimview";
+    }
+
+#ifdef _WIN32
+    l = 0;
+#endif
+
+    std::lock_guard<std::mutex> lock(mutex);
+    dir = resolved;
+    limit = l;
+}
+
+bool DiskCache::settings(std::string& d, size_t& l) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    d = dir;
+    l = limit;
+    return l > 0 && !d.empty();
+}
+
+bool DiskCache::enabled() const {
+    std::string d;
+    size_t l;
+    return settings(d, l);
+}
+
+std::shared_ptr<Image> DiskCache::load(const std::string& path, std::string& key){
+    key.clear();
+    std::string root;
+    size_t budget;
+    if(!settings(root, budget))
+        return nullptr;
+
+#ifdef _WIN32
+    return nullptr;
+#else
+    bool ok;
+    uint64_t h = hashFile(path, ok);
+    if(!ok)
+        return nullptr;
+
+    // the pyramid depends on the filter as much as on the source
+    char name[48];
+    snprintf(name, sizeof(name), "%016llx-%d.glpyr", (unsigned long long)h, (int)mipFilter());
+    key = root + "/" + name;
+
+    std::shared_ptr<Image> img = mapEntry(key);
+    if(img){
+        // the modification time doubles as the last use for eviction
+        std::error_code ec;
+        fs::last_write_time(key, fs::file_time_type::clock::now(), ec);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if(img)
+        counters.hits++;
+    else
+        counters.misses++;
+    return img;
+#endif
+}
+
+void DiskCache::store(const std::string& key, std::shared_ptr<Image> img){
+    if(key.empty() || !enabled())
+        return;
+
+    writer.submit([this, key, img](){
+        if(writeEntry(key, *img))
+            evict();
+        else
+            std::cerr << "Disk cache: cannot write " << key << "\n";
+    });
+}
+
+void DiskCache::evict(){
+    std::string root;
+    size_t budget;
+    if(!settings(root, budget))
+        return;
+
+    std::vector<std::tuple<fs::file_time_type, size_t, fs::path>> files;
+    size_t total = 0;
+    std::error_code ec;
+    auto now = fs::file_time_type::clock::now();
+    for(fs::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)){
+        std::string ext = it->path().extension().string();
+        if(ext.compare(0, 4, ".tmp") == 0){
+            // left behind by a process that exited mid-write
+            if(now - it->last_write_time(ec) > std::chrono::hours(1))
+                fs::remove(it->path(), ec);
+            continue;
+        }
+
+        if(ext != ".glpyr")
+            continue;
+
+        size_t size = (size_t)it->file_size(ec);
+        fs::file_time_type time = it->last_write_time(ec);
+        if(ec)
+            continue;
+
+        files.emplace_back(time, size, it->path());
+        total += size;
+    }
+
+    // oldest first
+    std::sort(files.begin(), files.end());
+    size_t kept = files.size();
+    for(auto &f : files){
+        if(total <= budget)
+            break;
+
+        if(fs::remove(std::get<2>(f), ec)){
+            total -= std::get<1>(f);
+            kept--;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.entries = kept;
+    counters.bytes = total;
+}
+
+void DiskCache::report(){
+    std::string root;
+    size_t budget;
+    if(!settings(root, budget))
+        return;
+
+    evict();
+    Stats s = stats();
+    std::cout << "Disk cache: " << s.entries << " images, " << (s.bytes >> 20) << " MB of "
+              << (budget >> 20) << " MB in " << root << "\n";
+}
+
+DiskCache::Stats DiskCache::stats(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+// XXH64
+
+static const uint64_t prime1 = 11400714785074694791ULL;
+static const uint64_t prime2 = 14029467366897019727ULL;
+static const uint64_t prime3 = 1609587929392839161ULL;
+static const uint64_t prime4 = 9650029242287828579ULL;
+static const uint64_t prime5 = 2870177450012600261ULL;
+
+static inline uint64_t rotl64(uint64_t x, int r){
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const unsigned char* p){
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint32_t read32(const unsigned char* p){
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t xxRound(uint64_t acc, uint64_t input){
+    acc += input * prime2;
+    acc = rotl64(acc, 31);
+    return acc * prime1;
+}
+
+static inline uint64_t xxMerge(uint64_t acc, uint64_t v){
+    acc ^= xxRound(0, v);
+    return acc * prime1 + prime4;
+}
+
+uint64_t hash64(const void* data, size_t size, uint64_t seed){
+    const unsigned char* p = (const unsigned char*)data;
+    const unsigned char* end = p + size;
+    uint64_t h;
+
+    if(size >= 32){
+        const unsigned char* limit = end - 32;
+        uint64_t v1 = seed + prime1 + prime2, v2 = seed + prime2, v3 = seed, v4 = seed - prime1;
+        do{
+            v1 = xxRound(v1, read64(p));
+            v2 = xxRound(v2, read64(p + 8));
+            v3 = xxRound(v3, read64(p + 16));
+            v4 = xxRound(v4, read64(p + 24));
+            p += 32;
+        } while(p <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxMerge(h, v1);
+        h = xxMerge(h, v2);
+        h = xxMerge(h, v3);
+        h = xxMerge(h, v4);
+    } else {
+        h = seed + prime5;
+    }
+
+    h += size;
+    for(; p + 8 <= end; p += 8){
+        h ^= xxRound(0, read64(p));
+        h = rotl64(h, 27) * prime1 + prime4;
+    }
+
+    if(p + 4 <= end){
+        h ^= (uint64_t)read32(p) * prime1;
+        h = rotl64(h, 23) * prime2 + prime3;
+        p += 4;
+    }
+
+    for(; p < end; p++){
+        h ^= *p * prime5;
+        h = rotl64(h, 11) * prime1;
+    }
+
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+    return h;
+}
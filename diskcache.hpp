@@ -0,0 +1,84 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef DISKCACHE_H
+#define DISKCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "image.hpp"
+#include "threadpool.hpp"
+
+// Decoded pyramids on disk, keyed by a hash of the source file's bytes
+// and the mip filter. An entry is one file holding every level (and the
+// thumbnail) uncompressed and page aligned. A hit maps it and the Image
+// points straight into the mapped pages, so tiles are filled from the
+// page cache with no decode and no intermediate copy.
+//
+// Entries are written on a background thread through a temporary file
+// and a rename. The least recently used are evicted to stay within the
+// size limit. Not available on Windows, where lookups always miss.
+class DiskCache{
+public:
+    struct Stats{
+        unsigned hits = 0, misses = 0;
+        size_t entries = 0, bytes = 0;
+    };
+
+    // An empty dir picks $XDG_CACHE_HOME/glimview or ~/.cache/glimview;
+    // a limit of 0 turns the cache off.
+    void configure(const std::string& dir, size_t limit);
+    bool enabled() const;
+
+    // Returns the cached image for path, or nullptr and the key to store
+    // the decoded image under.
+    std::shared_ptr<Image> load(const std::string& path, std::string& key);
+    // Queues img for writing; returns at once.
+    void store(const std::string& key, std::shared_ptr<Image> img);
+
+    // Prints the cache directory, its size and the limit.
+    void report();
+    Stats stats();
+
+private:
+    void evict();
+    // dir and limit as configured; false when the cache is off
+    bool settings(std::string& d, size_t& l) const;
+
+    // configure() runs on the render thread while loaders and the writer
+    // read these, so they are only touched under mutex
+    std::string dir;
+    size_t limit = 0;
+    mutable std::mutex mutex;
+    Stats counters;
+    ThreadPool writer{1};
+};
+
+// The process-wide cache used by decodeImage().
+DiskCache& diskCache();
+
+// 64-bit hash of a byte range (the XXH64 algorithm).
+uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+
+#endif // DISKCACHE_H
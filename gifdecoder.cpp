@@ -0,0 +1,327 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "gifdecoder.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+static int le16(const unsigned char* p){ return p[0] | p[1] << 8; }
+
+// Largest canvas taken, 256 MB of RGBA; the header alone could ask for
+// 16 GB, and the player keeps a few frames of it.
+static const size_t maxPixels = (size_t)1 << 26;
+
+bool GifDecoder::open(const std::string& path, std::string& err){
+    std::ifstream in(path, std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if(data.size() < 13 || (memcmp(data.data(), "GIF87a", 6) && memcmp(data.data(), "GIF89a", 6))){
+        err = "Not a GIF: " + path;
+        return false;
+    }
+
+    w = le16(&data[6]);
+    h = le16(&data[8]);
+    if((size_t)w * h > maxPixels){
+        err = "GIF too large: " + path + " (" + std::to_string(w) + "x" + std::to_string(h) + ")";
+        return false;
+    }
+    int packed = data[10];
+    pos = 13;
+    globalSize = 0;
+    if(packed & 0x80){
+        globalSize = 2 << (packed & 7);
+        if(pos + globalSize * 3 > data.size()){
+            err = "Truncated GIF: " + path;
+            return false;
+        }
+        memcpy(globalColors, &data[pos], globalSize * 3);
+        pos += globalSize * 3;
+    }
+    firstBlock = pos;
+
+    // walk the blocks once for the frame and loop counts
+    frameCount = 0;
+    playCount = 1;
+    bool ok = w > 0 && h > 0;
+    while(ok && pos < data.size() && data[pos] != 0x3B){
+        int block = data[pos++];
+        if(block == 0x21 && pos < data.size()){
+            int label = data[pos++];
+            if(label == 0xFF && pos + 15 < data.size() && data[pos] == 11 &&
+               !memcmp(&data[pos + 1], "NETSCAPE2.0", 11) && data[pos + 12] == 3){
+                int loops = le16(&data[pos + 14]);
+                playCount = loops == 0 ? 0 : loops + 1;
+            }
+            ok = skipSubBlocks();
+        } else if(block == 0x2C && pos + 9 < data.size()){
+            int flags = data[pos + 8];
+            pos += 9;
+            if(flags & 0x80)
+                pos += (2 << (flags & 7)) * 3;
+            pos++;              // LZW minimum code size
+            ok = skipSubBlocks();
+            frameCount++;
+        } else
+            ok = false;
+    }
+
+    if(frameCount == 0){
+        err = "No frames in GIF: " + path;
+        return false;
+    }
+
+    rewind();
+    return true;
+}
+
+void GifDecoder::rewind(){
+    pos = firstBlock;
+    canvas.assign((size_t)w * h * 4, 0);
+    dispose = 0;
+}
+
+bool GifDecoder::skipSubBlocks(){
+    while(pos < data.size()){
+        int n = data[pos++];
+        if(n == 0)
+            return true;
+        pos += n;
+    }
+    return false;
+}
+
+bool GifDecoder::decodeLzw(int minCode, size_t pixels, std::vector<unsigned char>& out){
+    // the data sub-blocks joined, then read LSB first
+    compressed.clear();
+    while(pos < data.size()){
+        int n = data[pos++];
+        if(n == 0)
+            break;
+        if(pos + n > data.size())
+            return false;
+        compressed.insert(compressed.end(), data.begin() + pos, data.begin() + pos + n);
+        pos += n;
+    }
+
+    if(minCode < 1 || minCode > 11)
+        return false;
+
+    static thread_local unsigned short prefix[4096];
+    static thread_local unsigned char suffix[4096], stack[4097];
+    int clear = 1 << minCode, end = clear + 1;
+    for(int i = 0; i < clear; i++)
+        suffix[i] = (unsigned char)i;
+
+    int codeSize = minCode + 1, next = clear + 2, old = -1;
+    unsigned char first = 0;
+    uint32_t bits = 0;
+    int nbits = 0;
+    size_t in = 0, written = 0;
+    out.assign(pixels, 0);
+    while(written < pixels){
+        while(nbits < codeSize && in < compressed.size()){
+            bits |= (uint32_t)compressed[in++] << nbits;
+            nbits += 8;
+        }
+        if(nbits < codeSize)
+            break;
+
+        int code = bits & ((1 << codeSize) - 1);
+        bits >>= codeSize;
+        nbits -= codeSize;
+
+        if(code == clear){
+            codeSize = minCode + 1;
+            next = clear + 2;
+            old = -1;
+            continue;
+        }
+        if(code == end)
+            break;
+
+        if(old < 0){
+            if(code >= clear)
+                return false;
+            first = (unsigned char)code;
+            out[written++] = first;
+            old = code;
+            continue;
+        }
+
+        // a code not in the table yet can only be the previous string
+        // followed by its own first byte
+        int sp = 0, c = code;
+        if(c >= next){
+            if(c > next)
+                return false;
+            stack[sp++] = first;
+            c = old;
+        }
+        while(c >= clear){
+            stack[sp++] = suffix[c];
+            c = prefix[c];
+        }
+        first = (unsigned char)c;
+        stack[sp++] = first;
+        while(sp > 0 && written < pixels)
+            out[written++] = stack[--sp];
+
+        if(next < 4096){
+            prefix[next] = (unsigned short)old;
+            suffix[next] = first;
+            next++;
+            if(next == 1 << codeSize && codeSize < 12)
+                codeSize++;
+        }
+        old = code;
+    }
+
+    // short data leaves the rest of the frame as it was
+    out.resize(written);
+    return true;
+}
+
+bool GifDecoder::next(unsigned char* result, int& delayMs, std::string& err){
+    // undo the previous frame as it asked
+    if(dispose == 2){
+        for(int y = prevY; y < prevY + prevH; y++)
+            memset(&canvas[((size_t)y * w + prevX) * 4], 0, (size_t)prevW * 4);
+    } else if(dispose == 3 && !saved.empty())
+        canvas.swap(saved);
+    dispose = 0;
+
+    int transparent = -1, disposal = 0;
+    delayMs = 100;
+    while(pos < data.size()){
+        int block = data[pos++];
+        if(block == 0x3B)
+            return false;
+
+        if(block == 0x21 && pos < data.size()){
+            int label = data[pos++];
+            if(label == 0xF9 && pos + 5 < data.size() && data[pos] == 4){
+                int flags = data[pos + 1];
+                disposal = (flags >> 2) & 7;
+                // like browsers: delays under 20 ms mean "as fast as
+                // the file could not say", shown at 100 ms
+                int cs = le16(&data[pos + 2]);
+                delayMs = cs < 2 ? 100 : cs * 10;
+                if(flags & 1)
+                    transparent = data[pos + 4];
+            }
+            if(!skipSubBlocks())
+                break;
+            continue;
+        }
+
+        if(block != 0x2C || pos + 10 > data.size())
+            break;
+
+        int fx = le16(&data[pos]), fy = le16(&data[pos + 2]);
+        int fw = le16(&data[pos + 4]), fh = le16(&data[pos + 6]);
+        int flags = data[pos + 8];
+        pos += 9;
+
+        const unsigned char* colors = globalColors;
+        int colorCount = globalSize;
+        if(flags & 0x80){
+            colorCount = 2 << (flags & 7);
+            if(pos + colorCount * 3 > data.size())
+                break;
+            colors = &data[pos];
+            pos += colorCount * 3;
+        }
+
+        // only the part on the canvas is drawn; a frame that misses it
+        // entirely is corrupt
+        if(fw == 0 || fh == 0 || fx >= w || fy >= h)
+            break;
+        int cw = std::min(fw, w - fx), ch = std::min(fh, h - fy);
+
+        // rows below the canvas are not needed unless interlacing puts
+        // visible rows after them
+        bool interlaced = (flags & 0x40) != 0;
+        size_t pixels = (size_t)fw * (interlaced ? fh : ch);
+        if(pixels > maxPixels)
+            break;
+
+        int minCode = pos < data.size() ? data[pos++] : 0;
+        if(!decodeLzw(minCode, pixels, indices))
+            break;
+
+        if(disposal == 3)
+            saved = canvas;
+
+        // interlaced frames come in four passes of rows
+        static const int passStart[4] = {0, 4, 2, 1}, passStep[4] = {8, 8, 4, 2};
+        int pass = 0, row = 0;
+        for(int r = 0; r < fh && (size_t)r * fw < indices.size(); r++){
+            int y = r;
+            if(interlaced){
+                while(row >= fh && pass < 3){
+                    pass++;
+                    row = passStart[pass];
+                }
+                y = row;
+                row += passStep[pass];
+            }
+
+            if(y >= ch)
+                continue;
+
+            size_t n = std::min((size_t)cw, indices.size() - (size_t)r * fw);
+            const unsigned char* src = &indices[(size_t)r * fw];
+            unsigned char* dst = &canvas[((size_t)(fy + y) * w) * 4];
+            for(size_t x = 0; x < n; x++){
+                int i = src[x];
+                if(i == transparent)
+                    continue;
+                unsigned char* p = dst + (size_t)(fx + x) * 4;
+                if(i < colorCount){
+                    p[0] = colors[i * 3];
+                    p[1] = colors[i * 3 + 1];
+                    p[2] = colors[i * 3 + 2];
+                } else
+                    p[0] = p[1] = p[2] = 0;
+                p[3] = 255;
+            }
+        }
+
+        dispose = disposal;
+        prevX = fx;
+        prevY = fy;
+        prevW = cw;
+        prevH = ch;
+
+        size_t stride = (size_t)w * 4;
+        for(int y = 0; y < h; y++)
+            memcpy(result + (size_t)(h - 1 - y) * stride, &canvas[y * stride], stride);
+        return true;
+    }
+
+    // a file cut short after its last full frame just ends there
+    if(pos < data.size())
+        err = "Corrupt GIF frame";
+    return false;
+}
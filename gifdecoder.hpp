@@ -0,0 +1,69 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef GIFDECODER_H
+#define GIFDECODER_H
+
+#include <string>
+#include <vector>
+
+// Frame-by-frame GIF decoding. Only the compressed file and one canvas
+// (two for "restore previous" frames) are held, however long the
+// animation is; frames are composited onto the canvas as they come.
+class GifDecoder{
+public:
+    // Reads the file and counts its frames without decoding them.
+    bool open(const std::string& path, std::string& err);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int frames() const { return frameCount; }
+    // How often the file asks to be played, 0 for forever: once without
+    // a NETSCAPE block, and like browsers one more than its loop count.
+    int plays() const { return playCount; }
+
+    // Decodes the next frame and copies the canvas, RGBA rows bottom to
+    // top, to out (width * height * 4 bytes), with how long it stays up.
+    // False at the end of the file (err empty) or on a corrupt frame.
+    bool next(unsigned char* out, int& delayMs, std::string& err);
+    // Back to the first frame, on an empty canvas.
+    void rewind();
+
+private:
+    bool skipSubBlocks();
+    bool decodeLzw(int minCode, size_t pixels, std::vector<unsigned char>& indices);
+
+    std::vector<unsigned char> data;
+    size_t pos = 0, firstBlock = 0;
+    int w = 0, h = 0;
+    int frameCount = 0, playCount = 1;
+    unsigned char globalColors[256 * 3];
+    int globalSize = 0;
+
+    std::vector<unsigned char> canvas;  // RGBA, top row first
+    std::vector<unsigned char> saved;   // canvas before a disposal 3 frame
+    std::vector<unsigned char> indices, compressed;
+    // what the previous frame asked to be done with its rectangle
+    int dispose = 0;
+    int prevX = 0, prevY = 0, prevW = 0, prevH = 0;
+};
+
+#endif // GIFDECODER_H
@@ -24,9 +24,92 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <cstddef>
+#include <string>
+#include <vector>
 
+// See glimviewoptions.hpp and stream.hpp; only needed to call the
+// functions taking them.
+struct GlimviewOptions;
+struct FrameFormat;
+
+void glimviewSetOptions(const GlimviewOptions& opts);
+// Both start decoding / mip building on a worker thread and return at once.
 void glimviewUpdateImage(unsigned char* data, int imgW, int imgH);
+void glimviewLoadFiles(const std::vector<std::string>& paths);
 int showGlimview();
 void freeData(void (*func)());
 
+// Replaces the w x h pixels at (x, y) of the image on show (RGBA8, rows
+// bottom to top, y counted from the bottom). Only that region is
+// uploaded and only the mip blocks depending on it are recomputed. The
+// pixels are copied; safe from any thread. Ignored while streaming. For
+// an image from glimviewUpdateImage they land in the buffer given there.
+void glimviewUpdateRegion(const unsigned char* rgba, int x, int y, int w, int h);
+
+// Writes the image as the first window (or the headless view) shows it
+// at its current pan and zoom, width pixels wide, to a .tga or .ppm
+// file. Rendered offscreen tile by tile, so width may be far beyond the
+// largest framebuffer. Call from the thread running the viewer.
+bool glimviewExport(const std::string& path, int width);
+
+// Live frames (RGBA8, rows bottom to top like glimviewUpdateImage) from a
+// producer thread, before or while showGlimview() runs. The pixels are
+// copied and the call never waits on the render loop; only the newest
+// frame is shown and any older one not displayed yet is dropped. Call
+// from one thread at a time.
+void glimviewSubmitFrame(const unsigned char* rgba, int w, int h);
+// The same for planar YUV 4:2:0 (see FrameFormat in stream.hpp), rows
+// top to bottom: planes and strides (bytes per row) are Y and UV for
+// NV12, Y, U and V for I420. The planes are uploaded as they are and
+// converted to RGB on the GPU with the format's matrix and range.
+void glimviewSubmitFrameYuv(const unsigned char* const planes[3], const int strides[3], int w, int h,
+                            const FrameFormat& format);
+
+struct GlimviewStreamStats{
+    unsigned long submitted = 0;
+    unsigned long displayed = 0;
+    unsigned long dropped = 0;      // replaced before they reached the screen
+    double latencyP50Ms = 0.0;      // submit -> buffer swap
+    double latencyP99Ms = 0.0;
+    double latencyMaxMs = 0.0;
+};
+
+GlimviewStreamStats glimviewStreamStats();
+
+// Single instance (see remote.hpp). glimviewServe() makes showGlimview()
+// also take files and images from other processes over a Unix socket,
+// the default one for an empty path. The remote calls hand them to such
+// a viewer and return once it has drawn them, with the round trip in
+// roundTripMs if given; false when no viewer listens or it failed. An
+// image (RGBA8, rows bottom to top) travels through shared memory.
+bool glimviewServe(const std::string& socketPath);
+bool glimviewRemoteFiles(const std::vector<std::string>& paths, const std::string& socketPath,
+                         double* roundTripMs);
+bool glimviewRemoteImage(const unsigned char* rgba, int w, int h, const std::string& socketPath,
+                         double* roundTripMs);
+
+// Headless driving, used by glimview_bench. The caller provides a current
+// GL 3.3 context with a framebuffer bound and feeds input in window
+// coordinates (origin at the top left, like GLFW).
+struct GlimviewHeadlessStats{
+    bool hasImage = false;
+    bool settled = false;
+    bool tilesPending = false;
+    double attachMs = -1.0;         // load start -> decoded image attached
+    double firstPixelMs = -1.0;     // load start -> first tile on screen
+    double fullImageMs = -1.0;      // load start -> no tiles outstanding
+    size_t tilesUploaded = 0;
+    size_t bytesUploaded = 0;
+    double uploadMs = 0.0;
+};
+
+void glimviewHeadlessInit(int width, int height);
+bool glimviewHeadlessFrame(double dt);
+void glimviewHeadlessShutdown();
+void glimviewHeadlessButton(int action, double x, double y);
+void glimviewHeadlessCursor(double x, double y);
+void glimviewHeadlessScroll(double x, double y, double yoffset);
+GlimviewHeadlessStats glimviewHeadlessStats();
+
 #endif // GLIMVIEW_H
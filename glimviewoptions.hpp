@@ -0,0 +1,55 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef GLIMVIEW_OPTIONS_H
+#define GLIMVIEW_OPTIONS_H
+
+#include "latency.hpp"
+#include "mappedimage.hpp"
+#include "mipmap.hpp"
+#include "resample.hpp"
+#include "texcompress.hpp"
+#include <cstddef>
+#include <string>
+
+// Settings for glimviewSetOptions / ViewerGroup. Kept out of glimview.hpp
+// so the API header does not drag in the modules the fields come from.
+struct GlimviewOptions{
+    size_t tileBudget = size_t(512) << 20;  // VRAM allowed for image tiles, in bytes
+    size_t cacheBudget = size_t(1024) << 20; // RAM for decoded neighbouring images
+    int prefetch = 2;                        // images decoded ahead and behind
+    bool hud = false;                        // frame timing graph, toggled with F1
+    std::string tracePath;                   // per-frame timings, CSV or .json
+    MipFilter mipFilter = MipFilter::Kaiser; // filter for the CPU mip pyramid
+    TextureCompression compression = TextureCompression::None; // tile format in VRAM
+    std::string diskCacheDir;                // empty for the per-user cache directory
+    size_t diskCacheBudget = size_t(2048) << 20; // decoded pyramids kept on disk, 0 disables
+    ResampleFilter resample = ResampleFilter::Bicubic; // on screen once the view is still
+    int swapInterval = 1;                    // vsyncs per swap, 0 off, -1 adaptive
+    FramePacing pacing = FramePacing::Off;   // keep the driver from queueing frames
+    bool lateInput = false;                  // read the cursor right before drawing
+    std::string exportPath = "glimview-export.tga"; // Ctrl+E target, .tga or .ppm
+    int exportWidth = 0;                     // pixels, 0 for four times the window
+    RawFormat raw;                           // layout of headerless .raw files
+    double sequenceFps = 0.0;                // > 0 plays the files as one animation
+};
+
+#endif // GLIMVIEW_OPTIONS_H
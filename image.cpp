@@ -0,0 +1,336 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "image.hpp"
+#include "mipmap.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+Orientation Orientation::then(const Orientation& o) const {
+    Orientation r;
+    r.m[0] = o.m[0] * m[0] + o.m[1] * m[2];
+    r.m[1] = o.m[0] * m[1] + o.m[1] * m[3];
+    r.m[2] = o.m[2] * m[0] + o.m[3] * m[2];
+    r.m[3] = o.m[2] * m[1] + o.m[3] * m[3];
+    return r;
+}
+
+Orientation Orientation::flipY(){
+    Orientation o;
+    o.m[3] = -1;
+    return o;
+}
+
+Orientation Orientation::mirrorX(){
+    Orientation o;
+    o.m[0] = -1;
+    return o;
+}
+
+Orientation Orientation::turnCW(){
+    // (x, y) -> (y, -x) with y up
+    Orientation o;
+    o.m[0] = 0;
+    o.m[1] = 1;
+    o.m[2] = -1;
+    o.m[3] = 0;
+    return o;
+}
+
+Orientation Orientation::fromExif(int tag){
+    // tags name the change that makes the stored image upright, mirror
+    // first; the flip turns top-first rows the right way up on screen
+    Orientation o = flipY();
+    Orientation cw = turnCW();
+    switch(tag){
+        case 2: return o.then(mirrorX());
+        case 3: return o.then(cw).then(cw);
+        case 4: return o.then(flipY());
+        case 5: return o.then(mirrorX()).then(cw).then(cw).then(cw);
+        case 6: return o.then(cw);
+        case 7: return o.then(mirrorX()).then(cw);
+        case 8: return o.then(cw).then(cw).then(cw);
+        default: return o;
+    }
+}
+
+void Orientation::toDisplay(float sx, float sy, int w, int h, float& dx, float& dy) const {
+    float x = sx - w * 0.5f, y = sy - h * 0.5f;
+    dx = m[0] * x + m[1] * y + displayW(w, h) * 0.5f;
+    dy = m[2] * x + m[3] * y + displayH(w, h) * 0.5f;
+}
+
+void Orientation::toStored(float dx, float dy, int w, int h, float& sx, float& sy) const {
+    // the inverse of a signed permutation is its transpose
+    float x = dx - displayW(w, h) * 0.5f, y = dy - displayH(w, h) * 0.5f;
+    sx = m[0] * x + m[2] * y + w * 0.5f;
+    sy = m[1] * x + m[3] * y + h * 0.5f;
+}
+
+void Orientation::matrix(int w, int h, float out[9]) const {
+    float tx, ty;
+    toDisplay(0.0f, 0.0f, w, h, tx, ty);
+    out[0] = (float)m[0]; out[1] = (float)m[2]; out[2] = 0.0f;
+    out[3] = (float)m[1]; out[4] = (float)m[3]; out[5] = 0.0f;
+    out[6] = tx;          out[7] = ty;          out[8] = 1.0f;
+}
+
+void expandToRgba(const unsigned char* src, int channels, bool bgr, unsigned char* dst, size_t n){
+    int r = bgr ? 2 : 0, b = 2 - r;
+    for(size_t i = 0; i < n; i++, src += channels, dst += 4){
+        switch(channels){
+            case 1: dst[0] = dst[1] = dst[2] = src[0]; dst[3] = 255; break;
+            case 2: dst[0] = dst[1] = dst[2] = src[0]; dst[3] = src[1]; break;
+            case 3: dst[0] = src[r]; dst[1] = src[1]; dst[2] = src[b]; dst[3] = 255; break;
+            default: dst[0] = src[r]; dst[1] = src[1]; dst[2] = src[b]; dst[3] = src[3];
+        }
+    }
+}
+
+void packFromRgba(const unsigned char* rgba, int channels, bool bgr, unsigned char* dst, size_t n){
+    int r = bgr ? 2 : 0, b = 2 - r;
+    for(size_t i = 0; i < n; i++, rgba += 4, dst += channels){
+        switch(channels){
+            case 1: dst[0] = rgba[0]; break;
+            case 2: dst[0] = rgba[0]; dst[1] = rgba[3]; break;
+            case 3: dst[r] = rgba[0]; dst[1] = rgba[1]; dst[b] = rgba[2]; break;
+            default: dst[r] = rgba[0]; dst[1] = rgba[1]; dst[b] = rgba[2]; dst[3] = rgba[3];
+        }
+    }
+}
+
+ImageLevel orientedRgba(const Image& img, const ImageLevel& lv, std::vector<unsigned char>& out){
+    const Orientation& o = img.orientation;
+    ImageLevel r;
+    r.w = o.displayW(lv.w, lv.h);
+    r.h = o.displayH(lv.w, lv.h);
+    r.stride = (size_t)r.w * 4;
+    out.resize(r.stride * r.h);
+    r.pixels = out.data();
+
+    // walk the display pixels, fetching the stored pixel under each centre
+    for(int y = 0; y < r.h; y++)
+        for(int x = 0; x < r.w; x++){
+            float sx, sy;
+            o.toStored(x + 0.5f, y + 0.5f, lv.w, lv.h, sx, sy);
+            int ix = std::min(std::max((int)sx, 0), lv.w - 1);
+            int iy = std::min(std::max((int)sy, 0), lv.h - 1);
+            expandToRgba(lv.pixels + iy * lv.stride + (size_t)ix * img.channels, img.channels, img.bgr,
+                         r.pixels + y * r.stride + (size_t)x * 4, 1);
+        }
+
+    return r;
+}
+
+uint64_t newImageId(){
+    static std::atomic<uint64_t> next{1};
+    return next++;
+}
+
+std::shared_ptr<Image> makeImage(unsigned char* data, int w, int h, int channels,
+                                 std::function<void()> release){
+    auto img = std::make_shared<Image>();
+    img->w = w;
+    img->h = h;
+    img->channels = channels;
+    img->release = std::move(release);
+
+    ImageLevel base;
+    base.w = w;
+    base.h = h;
+    base.stride = (size_t)w * channels;
+    base.pixels = data;
+    img->levels.push_back(base);
+    return img;
+}
+
+// Whether level 0 rows [y0, y1) have no alpha below 255.
+static bool opaqueRows(const Image& img, int y0, int y1){
+    if(img.channels != 2 && img.channels != 4)
+        return true;
+
+    const ImageLevel& base = img.levels[0];
+    for(int y = y0; y < y1; y++){
+        const unsigned char* row = base.pixels + y * base.stride;
+        for(int x = img.channels - 1; x < base.w * img.channels; x += img.channels)
+            if(row[x] != 255)
+                return false;
+    }
+
+    return true;
+}
+
+// src halved, in new storage of img.
+static ImageLevel halfLevel(Image& img, const ImageLevel& src){
+    ImageLevel dst;
+    dst.w = std::max(1, (src.w + 1) / 2);
+    dst.h = std::max(1, (src.h + 1) / 2);
+    dst.stride = (size_t)dst.w * img.channels;
+
+    img.storage.emplace_back(new unsigned char[dst.stride * dst.h]);
+    dst.pixels = img.storage.back().get();
+    return dst;
+}
+
+// Halves level 0 into dst in bands from the top, reporting after each
+// how many of its rows are no longer needed. With scanAlpha the opacity
+// check rides along, so the source is read in a single pass.
+static void halveBaseInBands(Image& img, ImageLevel& dst, bool scanAlpha,
+                             const std::function<void(int)>& consumed){
+    // no halving kernel reaches further than this above its output row
+    const int reach = 8;
+    const ImageLevel& src = img.levels[0];
+    int bandRows = (int)std::max<size_t>(64, (size_t(32) << 20) / (src.stride * 2));
+    int scanned = 0;
+    for(int y0 = 0; y0 < dst.h; y0 += bandRows){
+        int y1 = std::min(y0 + bandRows, dst.h);
+        int need = std::min(2 * y1 + reach, src.h);
+        if(scanAlpha && img.opaque)
+            img.opaque = opaqueRows(img, scanned, need);
+        scanned = need;
+
+        downsampleRegion(src, dst, img.channels, mipFilter(), 0, y0, dst.w, y1);
+        consumed(y1 == dst.h ? src.h : std::max(0, 2 * y1 - reach));
+    }
+}
+
+void buildPyramid(Image& img, int minSize, const std::function<void(int)>& consumed){
+    img.levels.resize(1);
+    img.storage.clear();
+    img.thumbnail = ImageLevel();
+
+    const ImageLevel& base = img.levels[0];
+    bool banded = consumed && std::max(base.w, base.h) > minSize;
+    img.opaque = banded || opaqueRows(img, 0, base.h);
+
+    while(std::max(img.levels.back().w, img.levels.back().h) > minSize){
+        const ImageLevel& src = img.levels.back();
+        ImageLevel dst = halfLevel(img, src);
+        if(banded && img.levels.size() == 1)
+            halveBaseInBands(img, dst, true, consumed);
+        else
+            downsampleLevel(src, dst, img.channels, mipFilter());
+        img.levels.push_back(dst);
+    }
+}
+
+void buildThumbnail(Image& img, int maxSize, const std::function<void(int)>& consumed){
+    ImageLevel level = img.levels.back();
+    bool fromBase = img.levels.size() == 1;
+    while(std::max(level.w, level.h) > maxSize){
+        ImageLevel dst = halfLevel(img, level);
+        if(consumed && fromBase && level.pixels == img.levels[0].pixels)
+            halveBaseInBands(img, dst, false, consumed);
+        else
+            downsampleLevel(level, dst, img.channels, mipFilter());
+        level = dst;
+    }
+
+    img.thumbnail = level;
+}
+
+// Copies read-only levels into memory of our own before they are written.
+static void makeWritable(Image& img){
+    auto copy = [&](ImageLevel& lv){
+        img.storage.emplace_back(new unsigned char[lv.stride * lv.h]);
+        memcpy(img.storage.back().get(), lv.pixels, lv.stride * lv.h);
+        lv.pixels = img.storage.back().get();
+    };
+
+    bool aliased = img.thumbnail.pixels == img.levels.back().pixels;
+    for(ImageLevel& lv : img.levels)
+        copy(lv);
+    if(aliased)
+        img.thumbnail = img.levels.back();
+    else
+        copy(img.thumbnail);
+
+    // the old levels, mapped or owned, stay until the image goes: encoder
+    // and stats jobs hold copies of the level pointers they were given
+    img.readOnly = false;
+}
+
+std::vector<ImageRect> updateRegion(Image& img, const unsigned char* pixels, size_t stride,
+                                    int x, int y, int w, int h){
+    if(img.readOnly)
+        makeWritable(img);
+
+    ImageLevel& base = img.levels[0];
+    size_t row = (size_t)w * img.channels;
+    for(int r = 0; r < h; r++){
+        unsigned char* dst = base.pixels + (y + r) * base.stride + (size_t)x * img.channels;
+        memcpy(dst, pixels + r * stride, row);
+
+        // new translucency flips the image to not opaque, never back
+        if(img.opaque && (img.channels == 2 || img.channels == 4))
+            for(size_t i = img.channels - 1; i < row; i += img.channels)
+                if(dst[i] != 255){
+                    img.opaque = false;
+                    break;
+                }
+    }
+
+    MipFilter filter = mipFilter();
+    std::vector<ImageRect> rects(1);
+    rects[0] = ImageRect{x, y, x + w, y + h};
+    for(size_t l = 1; l < img.levels.size(); l++){
+        ImageRect r = rects.back();
+        mipFootprint(filter, img.levels[l], r.x0, r.y0, r.x1, r.y1);
+        downsampleRegion(img.levels[l - 1], img.levels[l], img.channels, filter,
+                         r.x0, r.y0, r.x1, r.y1);
+        rects.push_back(r);
+    }
+
+    // the thumbnail is the top level halved until small enough; with one
+    // halving (the usual case) it is updated in place like a level,
+    // further steps are not kept and are redone in full
+    const ImageLevel& top = img.levels.back();
+    ImageRect thumb = rects.back();
+    if(img.thumbnail.pixels != top.pixels){
+        std::vector<std::unique_ptr<unsigned char[]>> steps;
+        ImageLevel src = top;
+        while(src.w != img.thumbnail.w || src.h != img.thumbnail.h){
+            ImageLevel dst;
+            dst.w = std::max(1, (src.w + 1) / 2);
+            dst.h = std::max(1, (src.h + 1) / 2);
+            dst.stride = (size_t)dst.w * img.channels;
+            if(dst.w == img.thumbnail.w && dst.h == img.thumbnail.h){
+                dst = img.thumbnail;
+                if(steps.empty()){
+                    mipFootprint(filter, dst, thumb.x0, thumb.y0, thumb.x1, thumb.y1);
+                    downsampleRegion(src, dst, img.channels, filter, thumb.x0, thumb.y0, thumb.x1, thumb.y1);
+                    break;
+                }
+            } else {
+                steps.emplace_back(new unsigned char[dst.stride * dst.h]);
+                dst.pixels = steps.back().get();
+            }
+
+            downsampleLevel(src, dst, img.channels, filter);
+            thumb = ImageRect{0, 0, dst.w, dst.h};
+            src = dst;
+        }
+    }
+
+    rects.push_back(thumb);
+    return rects;
+}
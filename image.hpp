@@ -0,0 +1,142 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct ImageLevel{
+    int w = 0, h = 0;
+    size_t stride = 0;              // bytes per row
+    unsigned char* pixels = nullptr;
+};
+
+// Pixels [x0, x1) x [y0, y1) of one level.
+struct ImageRect{
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+};
+
+// Where stored pixels land on screen: a 2x2 matrix of 0 / +-1 taking
+// offsets from the centre of the stored image to offsets from the centre
+// of the displayed one, y up. Flips, quarter turns and mirroring are
+// applied by the vertex shader through it and never touch the pixels.
+struct Orientation{
+    int m[4] = {1, 0, 0, 1};        // row major
+
+    bool swapsAxes() const { return m[0] == 0; }
+    int displayW(int w, int h) const { return swapsAxes() ? h : w; }
+    int displayH(int w, int h) const { return swapsAxes() ? w : h; }
+    bool operator==(const Orientation& o) const {
+        return m[0] == o.m[0] && m[1] == o.m[1] && m[2] == o.m[2] && m[3] == o.m[3];
+    }
+
+    // This followed by o, applied on screen.
+    Orientation then(const Orientation& o) const;
+    static Orientation flipY();
+    static Orientation mirrorX();
+    static Orientation turnCW();
+    // EXIF orientation tag (1-8) of an image stored top row first.
+    static Orientation fromExif(int tag);
+
+    // Position in a w x h stored image to display coordinates and back.
+    void toDisplay(float sx, float sy, int w, int h, float& dx, float& dy) const;
+    void toStored(float dx, float dy, int w, int h, float& sx, float& sy) const;
+    // The same as a column-major 3x3 affine matrix, for a mat3 uniform.
+    void matrix(int w, int h, float out[9]) const;
+};
+
+// A number no other image in the process has had or will have.
+uint64_t newImageId();
+
+// A decoded image and its CPU-side mip pyramid. Level 0 is the caller's
+// buffer and is handed back through `release`; coarser levels are owned.
+struct Image{
+    int w = 0, h = 0;
+    int channels = 4;               // 1 gray, 2 gray + alpha, 3 RGB, 4 RGBA
+    bool topFirst = false;          // rows stored top to bottom, as decoded from a file
+    Orientation orientation;        // display transform, topFirst's flip included
+    bool bgr = false;               // blue before red (BMP, TGA), swapped on sampling
+    bool opaque = true;             // no alpha below 255 in level 0
+    bool readOnly = false;          // some levels are mapped read-only (disk cache, mapped files)
+    std::vector<ImageLevel> levels;
+    ImageLevel thumbnail;           // small copy for overviews, may alias a level
+    std::vector<std::unique_ptr<unsigned char[]>> storage;
+    std::function<void()> release;
+    // Tells images apart where an address cannot: a new one may be
+    // allocated where a freed one was.
+    const uint64_t id = newImageId();
+
+    Image() = default;
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+    ~Image(){ if(release) release(); }
+
+    // Memory held by all levels, level 0 included.
+    size_t bytes() const {
+        size_t n = 0;
+        for(const ImageLevel& l : levels)
+            n += l.stride * l.h;
+        if(thumbnail.pixels != levels.back().pixels)
+            n += thumbnail.stride * thumbnail.h;
+        return n;
+    }
+};
+
+std::shared_ptr<Image> makeImage(unsigned char* data, int w, int h, int channels,
+                                 std::function<void()> release);
+
+// RGBA copy of n pixels of the given channel count, gray replicated to
+// RGB and alpha 255 where there is none, red and blue swapped for bgr.
+void expandToRgba(const unsigned char* src, int channels, bool bgr, unsigned char* dst, size_t n);
+// The reverse: keeps R (and A for gray + alpha, G and B for RGB).
+void packFromRgba(const unsigned char* rgba, int channels, bool bgr, unsigned char* dst, size_t n);
+
+// RGBA copy of one level of img (small ones: thumbnails) turned the way
+// it is displayed, into out. The level's pixels alias out.
+ImageLevel orientedRgba(const Image& img, const ImageLevel& lv, std::vector<unsigned char>& out);
+
+// Halves level after level with the current mip filter (see mipmap.hpp)
+// until the whole level fits in a single minSize x minSize tile. Also
+// notes whether the image is opaque. With consumed, level 0 is read once
+// from the top in bands and consumed(n) is called as soon as its first n
+// rows will not be read again (a mapped file drops them from memory).
+void buildPyramid(Image& img, int minSize, const std::function<void(int)>& consumed = nullptr);
+
+// Keeps halving past the top of the pyramid until the image fits in
+// maxSize x maxSize and stores the result as img.thumbnail. consumed as
+// for buildPyramid, when there is no pyramid yet.
+void buildThumbnail(Image& img, int maxSize, const std::function<void(int)>& consumed = nullptr);
+
+// Copies w x h pixels (rows of stride bytes, same channel count as img)
+// into level 0 at (x, y) and recomputes only the parts of the coarser
+// levels and the thumbnail that depend on them, so the cost follows the
+// size of the change. Returns the changed rectangle of every level,
+// with the thumbnail's last. The rectangle must lie inside the image.
+std::vector<ImageRect> updateRegion(Image& img, const unsigned char* pixels, size_t stride,
+                                    int x, int y, int w, int h);
+
+#endif // IMAGE_H
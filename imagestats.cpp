@@ -0,0 +1,254 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "imagestats.hpp"
+#include "mipmap.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <vector>
+
+int ImageStats::min(int c) const {
+    for(int v = 0; v < 256; v++)
+        if(hist[c][v])
+            return v;
+    return -1;
+}
+
+int ImageStats::max(int c) const {
+    for(int v = 255; v >= 0; v--)
+        if(hist[c][v])
+            return v;
+    return -1;
+}
+
+double ImageStats::mean(int c) const {
+    uint64_t sum = 0;
+    for(int v = 0; v < 256; v++)
+        sum += hist[c][v] * v;
+    return pixels ? (double)sum / pixels : 0.0;
+}
+
+// Counts of one band. Even and odd pixels go to separate tables, so runs
+// of equal values (flat areas, clipped skies) do not serialise on a
+// single counter.
+struct Counts{
+    uint32_t n[2][4][256];
+};
+
+// Counts rows [y0, y1) of r.
+static void countBand(const ImageLevel& lv, int channels, const ImageRect& r, int y0, int y1,
+                      Counts& counts){
+    memset(&counts, 0, sizeof(counts));
+    auto &n = counts.n;
+    int w = r.x1 - r.x0;
+    for(int y = y0; y < y1; y++){
+        const unsigned char* p = lv.pixels + y * lv.stride + (size_t)r.x0 * channels;
+        if(channels == 4){
+            int x = 0;
+            for(; x + 2 <= w; x += 2, p += 8){
+                n[0][0][p[0]]++;
+                n[0][1][p[1]]++;
+                n[0][2][p[2]]++;
+                n[0][3][p[3]]++;
+                n[1][0][p[4]]++;
+                n[1][1][p[5]]++;
+                n[1][2][p[6]]++;
+                n[1][3][p[7]]++;
+            }
+            for(; x < w; x++, p += 4)
+                for(int c = 0; c < 4; c++)
+                    n[0][c][p[c]]++;
+        } else {
+            for(int x = 0; x < w; x++)
+                for(int c = 0; c < channels; c++)
+                    n[x & 1][c][*p++]++;
+        }
+    }
+}
+
+void accumulateStats(const ImageLevel& lv, int channels, const ImageRect& r, int sign, ImageStats& st){
+    if(r.empty())
+        return;
+
+    std::mutex mutex;
+    auto merge = [&](const Counts& counts, uint64_t pixels){
+        std::lock_guard<std::mutex> lock(mutex);
+        for(int c = 0; c < channels; c++)
+            for(int v = 0; v < 256; v++){
+                uint64_t n = (uint64_t)counts.n[0][c][v] + counts.n[1][c][v];
+                st.hist[c][v] += sign > 0 ? n : 0 - n;
+            }
+        st.pixels += sign > 0 ? pixels : 0 - pixels;
+    };
+
+    // bands of at least 64K pixels, about four per worker
+    ThreadPool& pool = mipWorkers();
+    int rows = r.y1 - r.y0;
+    int w = r.x1 - r.x0;
+    int bandRows = std::max(std::max(65536 / w, 1), rows / (int)(pool.size() * 4));
+    int bands = (rows + bandRows - 1) / bandRows;
+    if(bands <= 1){
+        std::unique_ptr<Counts> counts(new Counts);
+        countBand(lv, channels, r, r.y0, r.y1, *counts);
+        merge(*counts, (uint64_t)w * rows);
+        return;
+    }
+
+    std::condition_variable done;
+    int remaining = bands;
+    for(int b = 0; b < bands; b++){
+        int by0 = r.y0 + b * bandRows;
+        int by1 = std::min(r.y1, by0 + bandRows);
+        pool.submit([&, by0, by1](){
+            std::unique_ptr<Counts> counts(new Counts);
+            countBand(lv, channels, r, by0, by1, *counts);
+            merge(*counts, (uint64_t)w * (by1 - by0));
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--remaining == 0)
+                done.notify_all();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&](){ return remaining == 0; });
+}
+
+// a minus b as up to four rectangles: the rows above and below b, then
+// the columns beside it
+static void subtract(const ImageRect& a, const ImageRect& b, std::vector<ImageRect>& out){
+    ImageRect i{std::max(a.x0, b.x0), std::max(a.y0, b.y0), std::min(a.x1, b.x1), std::min(a.y1, b.y1)};
+    if(i.empty()){
+        out.push_back(a);
+        return;
+    }
+
+    ImageRect parts[4] = {
+        {a.x0, a.y0, a.x1, i.y0},
+        {a.x0, i.y1, a.x1, a.y1},
+        {a.x0, i.y0, i.x0, i.y1},
+        {i.x1, i.y0, a.x1, i.y1}
+    };
+    for(const ImageRect& p : parts)
+        if(!p.empty())
+            out.push_back(p);
+}
+
+// Counts are kept in storage order; BGR images are published as RGB.
+static ImageStats rgbOrder(const ImageStats& st, bool bgr){
+    ImageStats out = st;
+    if(bgr && st.channels >= 3)
+        std::swap(out.hist[0], out.hist[2]);
+    return out;
+}
+
+static uint64_t area(const ImageRect& r){
+    return r.empty() ? 0 : (uint64_t)(r.x1 - r.x0) * (r.y1 - r.y0);
+}
+
+void StatsEngine::request(const std::shared_ptr<Image>& img, const ImageRect& region){
+    if(!img)
+        return;
+
+    ImageRect r{std::max(region.x0, 0), std::max(region.y0, 0),
+                std::min(region.x1, img->w), std::min(region.y1, img->h)};
+    ImageLevel base = img->levels[0];
+    uint64_t n = ++requested;
+    worker.clear();
+    worker.submit([this, img, base, r, n](){
+        run(img, base, r);
+        // also wakes region updates held back while this counted
+        finished = n;
+        if(notify)
+            notify();
+    });
+}
+
+void StatsEngine::run(std::shared_ptr<Image> img, ImageLevel base, ImageRect region){
+    int channels = img->channels;
+    if(stale.exchange(false) || img->id != counted){
+        std::unique_ptr<ImageStats> st(new ImageStats);
+        st->source = img->id;
+        st->channels = channels;
+        st->rect = ImageRect{0, 0, img->w, img->h};
+        accumulateStats(base, channels, st->rect, 1, *st);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        wholeStats = rgbOrder(*st, img->bgr);
+        haveWhole = true;
+        counted = img->id;
+        last.reset();
+    }
+
+    if(last && last->rect.x0 == region.x0 && last->rect.y0 == region.y0 &&
+       last->rect.x1 == region.x1 && last->rect.y1 == region.y1)
+        return;
+
+    // pan and small zoom steps change a little of the region; count
+    // only that unless it is more than a fresh count would be
+    std::vector<ImageRect> removed, added;
+    if(last){
+        subtract(last->rect, region, removed);
+        subtract(region, last->rect, added);
+    }
+
+    uint64_t changed = 0;
+    for(const ImageRect& r : removed)
+        changed += area(r);
+    for(const ImageRect& r : added)
+        changed += area(r);
+
+    if(last && changed < area(region)){
+        for(const ImageRect& r : removed)
+            accumulateStats(base, channels, r, -1, *last);
+        for(const ImageRect& r : added)
+            accumulateStats(base, channels, r, 1, *last);
+    } else {
+        last.reset(new ImageStats);
+        last->source = img->id;
+        last->channels = channels;
+        accumulateStats(base, channels, region, 1, *last);
+    }
+    last->rect = region;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        regionStats = rgbOrder(*last, img->bgr);
+        haveRegion = true;
+    }
+
+    fresh = true;
+}
+
+bool StatsEngine::whole(ImageStats& st){
+    std::lock_guard<std::mutex> lock(mutex);
+    if(haveWhole)
+        st = wholeStats;
+    return haveWhole;
+}
+
+bool StatsEngine::region(ImageStats& st){
+    std::lock_guard<std::mutex> lock(mutex);
+    if(haveRegion)
+        st = regionStats;
+    return haveRegion;
+}
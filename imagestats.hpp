@@ -0,0 +1,100 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef IMAGESTATS_H
+#define IMAGESTATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "image.hpp"
+#include "threadpool.hpp"
+
+// Per-channel histograms of a rectangle of an image. Everything else
+// (range, mean, clipping) is read off them, so the counts can also be
+// updated by adding and removing rectangles of pixels.
+struct ImageStats{
+    uint64_t source = 0;            // Image::id of what was counted
+    ImageRect rect;                 // level 0 pixels counted
+    int channels = 0;
+    uint64_t pixels = 0;
+    uint64_t hist[4][256] = {};
+
+    // -1 when nothing was counted
+    int min(int c) const;
+    int max(int c) const;
+    double mean(int c) const;
+    uint64_t clippedLow(int c) const { return hist[c][0]; }
+    uint64_t clippedHigh(int c) const { return hist[c][255]; }
+};
+
+// Adds (sign 1) or removes (sign -1) the pixels of r, which must lie
+// inside lv, to / from st. Rows are split across a shared pool of
+// worker threads; returns when done.
+void accumulateStats(const ImageLevel& lv, int channels, const ImageRect& r, int sign, ImageStats& st);
+
+// Statistics of one view, computed on a background thread: the whole
+// image once per image, and the visible region whenever it changes. A
+// region overlapping the previous one is updated by counting only the
+// strips that entered and left it. Requests that pile up while one runs
+// are dropped in favour of the newest.
+class StatsEngine{
+public:
+    // Called from the background thread whenever a request is done.
+    void setNotify(void (*fn)()) { notify = fn; }
+
+    // Level 0 rectangle region of img (clipped to it). Returns at once.
+    void request(const std::shared_ptr<Image>& img, const ImageRect& region);
+    // The image's pixels changed; the next request counts everything again.
+    void invalidate() { stale = true; }
+    // A request is queued or counting. Level 0 is read in place, so it
+    // must not be written until this is false. Same thread as request().
+    bool busy() const { return finished != requested; }
+
+    // Latest results, false until there are any.
+    bool whole(ImageStats& st);
+    bool region(ImageStats& st);
+    // True once after new results arrived.
+    bool takeFresh() { return fresh.exchange(false); }
+
+private:
+    void run(std::shared_ptr<Image> img, ImageLevel base, ImageRect region);
+
+    void (*notify)() = nullptr;
+    std::atomic<bool> stale{false};
+    std::atomic<bool> fresh{false};
+    uint64_t requested = 0;
+    std::atomic<uint64_t> finished{0};
+
+    std::mutex mutex;
+    ImageStats wholeStats, regionStats;
+    bool haveWhole = false, haveRegion = false;
+
+    // background thread only
+    uint64_t counted = 0;           // Image::id
+    std::unique_ptr<ImageStats> last;   // previous region, the base for deltas
+
+    // last so its thread is joined before the state it touches goes away
+    ThreadPool worker{1};
+};
+
+#endif // IMAGESTATS_H
@@ -0,0 +1,90 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "latency.hpp"
+#include <algorithm>
+
+bool parseFramePacing(const std::string& name, FramePacing& pacing){
+    if(name == "off")
+        pacing = FramePacing::Off;
+    else if(name == "fence")
+        pacing = FramePacing::Fence;
+    else if(name == "finish")
+        pacing = FramePacing::Finish;
+    else
+        return false;
+
+    return true;
+}
+
+const char* framePacingName(FramePacing pacing){
+    switch(pacing){
+        case FramePacing::Fence: return "fence";
+        case FramePacing::Finish: return "finish";
+        default: return "off";
+    }
+}
+
+void FramePacer::wait(){
+    if(!fence)
+        return;
+
+    // bounded, so a hung driver costs a slow frame rather than a freeze
+    glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+    glDeleteSync(fence);
+    fence = 0;
+}
+
+void FramePacer::swapped(){
+    if(mode == FramePacing::Finish)
+        glFinish();
+    else if(mode == FramePacing::Fence && !fence)
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void FramePacer::destroy(){
+    if(fence)
+        glDeleteSync(fence);
+    fence = 0;
+}
+
+void LatencyLog::add(double v){
+    if(ms.size() < samples)
+        ms.push_back(v);
+    else
+        ms[pos++ % samples] = v;
+}
+
+LatencyLog::Summary LatencyLog::summary() const {
+    Summary s;
+    if(ms.empty())
+        return s;
+
+    std::vector<double> sorted = ms;
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    s.count = n;
+    s.p50Ms = sorted[n / 2];
+    s.p90Ms = sorted[std::min(n - 1, n * 9 / 10)];
+    s.p99Ms = sorted[std::min(n - 1, n * 99 / 100)];
+    s.maxMs = sorted.back();
+    return s;
+}
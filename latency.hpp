@@ -0,0 +1,77 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// How far the CPU may run ahead of the GPU. Off leaves it to the
+// driver, which typically queues two or three frames; Fence waits before
+// each frame until the previous one has finished on the GPU; Finish
+// blocks right after the swap until it completes.
+enum class FramePacing{
+    Off,
+    Fence,
+    Finish
+};
+
+bool parseFramePacing(const std::string& name, FramePacing& pacing);
+const char* framePacingName(FramePacing pacing);
+
+// Per-context pacing state for one window.
+class FramePacer{
+public:
+    void setMode(FramePacing m) { mode = m; }
+    // Before the frame's input is read.
+    void wait();
+    // Right after the swap.
+    void swapped();
+    void destroy();
+
+private:
+    FramePacing mode = FramePacing::Off;
+    GLsync fence = 0;
+};
+
+// Input-to-swap times of the frames that showed new input, over the most
+// recent frames.
+class LatencyLog{
+public:
+    static constexpr size_t samples = 8192;
+
+    struct Summary{
+        size_t count = 0;
+        double p50Ms = 0.0, p90Ms = 0.0, p99Ms = 0.0, maxMs = 0.0;
+    };
+
+    void add(double ms);
+    Summary summary() const;
+
+private:
+    std::vector<double> ms;
+    size_t pos = 0;
+};
+
+#endif // LATENCY_H
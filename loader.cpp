@@ -0,0 +1,216 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "loader.hpp"
+#include "diskcache.hpp"
+#include "mappedimage.hpp"
+#include "minimap.hpp"
+#include "tiledimage.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// EXIF orientation tag of a JPEG, 1 (upright) when there is none. Only
+// the APP1 segments before the image data are looked at.
+static int exifOrientation(const std::string& path){
+    FILE* f = fopen(path.c_str(), "rb");
+    if(!f)
+        return 1;
+
+    unsigned char buf[65536];
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    if(n < 4 || buf[0] != 0xFF || buf[1] != 0xD8)
+        return 1;
+
+    size_t pos = 2;
+    while(pos + 4 <= n && buf[pos] == 0xFF){
+        int marker = buf[pos + 1];
+        size_t len = (size_t)buf[pos + 2] << 8 | buf[pos + 3];
+        if(marker == 0xDA || len < 2)
+            break;
+
+        const unsigned char* seg = buf + pos + 4;
+        size_t segLen = std::min(len - 2, n - (pos + 4));
+        if(marker == 0xE1 && segLen > 14 && !memcmp(seg, "Exif\0\0", 6)){
+            const unsigned char* tiff = seg + 6;
+            size_t size = segLen - 6;
+            bool le = tiff[0] == 'I';
+            auto u16 = [&](size_t o){ return o + 2 > size ? 0u : le ? tiff[o] | tiff[o + 1] << 8u
+                                                                     : tiff[o] << 8u | tiff[o + 1]; };
+            auto u32 = [&](size_t o){ return o + 4 > size ? 0u : le ? u16(o) | u16(o + 2) << 16u
+                                                                     : u16(o) << 16u | u16(o + 2); };
+            size_t ifd = u32(4);
+            unsigned count = u16(ifd);
+            for(unsigned i = 0; i < count; i++){
+                size_t e = ifd + 2 + i * 12;
+                if(u16(e) == 0x0112){
+                    unsigned v = u16(e + 8);
+                    return v >= 1 && v <= 8 ? (int)v : 1;
+                }
+            }
+            return 1;
+        }
+
+        pos += 2 + len;
+    }
+
+    return 1;
+}
+
+// Decodes at the file's own channel count with the rows as stored (top
+// first, stb's default, which nothing in the process changes); the flip
+// and any EXIF turn are left to the vertex shader.
+static std::shared_ptr<Image> decodeFile(const std::string& path, std::string& err){
+    int w, h, channels;
+    unsigned char* data = stbi_load(path.c_str(), &w, &h, &channels, 0);
+    if(!data){
+        err = "Failed to load image: " + path;
+        return nullptr;
+    }
+
+    auto img = makeImage(data, w, h, channels, [data](){ stbi_image_free(data); });
+    img->topFirst = true;
+    img->orientation = Orientation::fromExif(exifOrientation(path));
+    return img;
+}
+
+std::shared_ptr<Image> decodeImage(const std::string& path, std::string& err){
+    // files needing no decode are their own level 0, read from the page
+    // cache; a disk cache entry would only be a second copy of them
+    if(std::shared_ptr<Image> img = mapImageFile(path, err)){
+        const Image& mapped = *img;
+        auto consumed = [&mapped](int rows){ releaseMappedRows(mapped, rows); };
+        buildPyramid(*img, TiledImage::tileSize, consumed);
+        buildThumbnail(*img, Minimap::thumbnailSize);
+        releaseMappedRows(*img, img->h);
+        return img;
+    }
+
+    if(!err.empty())
+        return nullptr;
+
+    std::string key;
+    if(std::shared_ptr<Image> img = diskCache().load(path, key))
+        return img;
+
+    std::shared_ptr<Image> img = decodeFile(path, err);
+    if(!img)
+        return nullptr;
+
+    buildPyramid(*img, TiledImage::tileSize);
+    buildThumbnail(*img, Minimap::thumbnailSize);
+    diskCache().store(key, img);
+    return img;
+}
+
+std::shared_ptr<Image> decodeFrame(const std::string& path, std::string& err){
+    std::shared_ptr<Image> img = mapImageFile(path, err);
+    if(img || !err.empty())
+        return img;
+
+    return decodeFile(path, err);
+}
+
+std::shared_ptr<Image> decodeThumbnail(const std::string& path, int maxSize, std::string& err){
+    if(std::shared_ptr<Image> img = mapImageFile(path, err)){
+        const Image& mapped = *img;
+        buildThumbnail(*img, maxSize, [&mapped](int rows){ releaseMappedRows(mapped, rows); });
+        releaseMappedRows(*img, img->h);
+        return img;
+    }
+
+    if(!err.empty())
+        return nullptr;
+
+    std::string key;
+    std::shared_ptr<Image> cached = diskCache().load(path, key);
+    if(cached && std::max(cached->thumbnail.w, cached->thumbnail.h) <= maxSize)
+        return cached;
+
+    std::shared_ptr<Image> img = decodeFile(path, err);
+    if(!img)
+        return nullptr;
+
+    buildThumbnail(*img, maxSize);
+    return img;
+}
+
+// Never waits for the job before: one not started yet is dropped, and
+// the result of one running is thrown away when it finishes.
+void ImageLoader::start(std::function<std::shared_ptr<Image>(std::string&)> job){
+    uint64_t gen;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        gen = ++generation;
+        ready.reset();
+        hasFailed = false;
+        message.clear();
+    }
+
+    worker.clear();
+    worker.submit([this, job, gen](){
+        std::string err;
+        std::shared_ptr<Image> img = job(err);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(gen != generation)
+                return;
+            ready = img;
+            hasFailed = !img;
+            message = err;
+        }
+
+        if(notify)
+            notify();
+    });
+}
+
+void ImageLoader::adopt(unsigned char* data, int w, int h, int channels,
+                        std::function<void()> release){
+    // made here so a job dropped before it runs still hands the buffer
+    // back through release
+    auto img = makeImage(data, w, h, channels, std::move(release));
+    start([img](std::string&){
+        buildPyramid(*img, TiledImage::tileSize);
+        buildThumbnail(*img, Minimap::thumbnailSize);
+        return img;
+    });
+}
+
+std::shared_ptr<Image> ImageLoader::poll(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::move(ready);
+}
+
+bool ImageLoader::failed(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return hasFailed;
+}
+
+std::string ImageLoader::error(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return message;
+}
@@ -0,0 +1,78 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "image.hpp"
+#include "threadpool.hpp"
+
+// Builds the mip pyramid of an image handed over by the application on a
+// worker thread, so the render thread can open the window right away and
+// pick the result up with poll() once it is ready. Files go through the
+// Playlist instead. A new image replaces one still being worked on
+// without waiting for it: the old result is dropped when it comes.
+class ImageLoader{
+public:
+    void adopt(unsigned char* data, int w, int h, int channels,
+               std::function<void()> release);
+
+    // Called from the worker thread when an image is ready or failed.
+    void setNotify(std::function<void()> fn) { notify = std::move(fn); }
+
+    // Returns a finished image exactly once, nullptr while still working.
+    std::shared_ptr<Image> poll();
+    bool failed();
+    std::string error();
+
+private:
+    void start(std::function<std::shared_ptr<Image>(std::string&)> job);
+
+    std::mutex mutex;
+    uint64_t generation = 0;        // of the newest start(), under mutex
+    std::shared_ptr<Image> ready;
+    bool hasFailed = false;
+    std::string message;
+    std::function<void()> notify;
+
+    // last so its thread is joined before the state it touches goes away
+    ThreadPool worker{1};
+};
+
+// Blocking decode of path into an image with its pyramid. Returns nullptr
+// and fills err on failure.
+std::shared_ptr<Image> decodeImage(const std::string& path, std::string& err);
+
+// Blocking decode of path to level 0 as stored, with no pyramid and no
+// disk cache; files that need no decoding are mapped.
+std::shared_ptr<Image> decodeFrame(const std::string& path, std::string& err);
+
+// Blocking decode of path down to just its thumbnail, at most maxSize on
+// a side, skipping the pyramid. A disk cache entry is used when there is
+// one but none is written. Returns nullptr and fills err on failure.
+std::shared_ptr<Image> decodeThumbnail(const std::string& path, int maxSize, std::string& err);
+
+#endif // LOADER_H
@@ -19,36 +19,203 @@
  *    SOFTWARE.
  */
 
-#include "glimview.hpp"
+#include "batch.hpp"
+#include "playlist.hpp"
+#include "remote.hpp"
+#include "viewer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
-unsigned char* data;
-
-void freeImage()
-{
-    stbi_image_free(data);
+static void usage(const char* argv0){
+    std::cout << "Usage: " << argv0 << " [options] image|directory|@list ...\n"
+              << "       " << argv0 << " --batch [batch options] image|directory|@list ...\n"
+              << "Options:\n"
+              << "  --vram-budget MB   GPU memory for image tiles (default 512)\n"
+              << "  --cache-budget MB  RAM for prefetched images (default 1024)\n"
+              << "  --prefetch N       images decoded ahead and behind (default 2)\n"
+              << "  --hud              show the frame timing graph (F1 toggles)\n"
+              << "  --trace FILE       write per-frame timings to FILE (.csv or .json)\n"
+              << "  --mip-filter F     box, kaiser or lanczos (default kaiser)\n"
+              << "  --compress MODE    tile format: none, bc1, bc7 or auto (default none)\n"
+              << "  --filter F         bilinear, nearest, bicubic or lanczos (default bicubic)\n"
+              << "  --swap-interval N  vsyncs per buffer swap, 0 off, -1 adaptive (default 1)\n"
+              << "  --pacing MODE      off, fence or finish: limit frames queued ahead (default off)\n"
+              << "  --late-input       read the cursor just before drawing a drag\n"
+              << "  --low-latency      same as --late-input --pacing fence\n"
+              << "  --disk-cache DIR   where decoded pyramids are cached (default ~/.cache/glimview)\n"
+              << "  --disk-cache-size MB  disk used for cached pyramids, 0 disables (default 2048)\n"
+              << "  --export FILE      where Ctrl+E saves the view, .tga or .ppm (default glimview-export.tga)\n"
+              << "  --export-width N   width of the export in pixels (default four times the window)\n"
+              << "  --raw WxH[:F[:S[:O]]]  layout of .raw files: format gray, graya, rgb, rgba,\n"
+              << "                     bgr or bgra (default rgba), row stride and offset in bytes\n"
+              << "  --fps N            play the files as the frames of one animation at N per second\n"
+              << "  --windows N        open N windows on the image, spread over the monitors\n"
+              << "  --server           also show files sent by --remote, with or without files of its own\n"
+              << "  --remote           show the files in the running --server viewer; without\n"
+              << "                     one, open them here and become that viewer\n"
+              << "  --socket PATH      socket of --server and --remote (default in $XDG_RUNTIME_DIR)\n"
+              << "Batch options (no window is opened):\n"
+              << "  --out DIR          output directory (default thumbnails)\n"
+              << "  --size N           longest side of each output (default 256)\n"
+              << "  --scale F          or a fraction of the input size, e.g. 0.5\n"
+              << "  --format F         jpg, png, bmp or tga (default jpg)\n"
+              << "  --quality Q        JPEG quality (default 90)\n"
+              << "  --threads N        worker threads (default one per core)\n"
+              << "  --cache-budget MB and --mip-filter F also apply\n";
 }
 
 int main(int argc, char** argv){
-    if(argc < 2){
-        std::cout << "Usage: " << argv[0] << " path_to_image\n";
+    GlimviewOptions opts;
+    std::vector<std::string> args;
+    int windows = 1;
+    bool batch = false;
+    bool server = false, remote = false;
+    std::string socketPath;
+    BatchOptions batchOpts;
+
+    for(int i = 1; i < argc; i++){
+        if(!strcmp(argv[i], "--vram-budget") && i + 1 < argc)
+            opts.tileBudget = (size_t)atol(argv[++i]) << 20;
+        else if(!strcmp(argv[i], "--cache-budget") && i + 1 < argc)
+            opts.cacheBudget = (size_t)atol(argv[++i]) << 20;
+        else if(!strcmp(argv[i], "--prefetch") && i + 1 < argc)
+            opts.prefetch = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--hud"))
+            opts.hud = true;
+        else if(!strcmp(argv[i], "--trace") && i + 1 < argc)
+            opts.tracePath = argv[++i];
+        else if(!strcmp(argv[i], "--mip-filter") && i + 1 < argc){
+            if(!parseMipFilter(argv[++i], opts.mipFilter)){
+                usage(argv[0]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "--compress") && i + 1 < argc){
+            if(!parseTextureCompression(argv[++i], opts.compression)){
+                usage(argv[0]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "--filter") && i + 1 < argc){
+            if(!parseResampleFilter(argv[++i], opts.resample)){
+                usage(argv[0]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "--pacing") && i + 1 < argc){
+            if(!parseFramePacing(argv[++i], opts.pacing)){
+                usage(argv[0]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "--raw") && i + 1 < argc){
+            if(!parseRawFormat(argv[++i], opts.raw)){
+                usage(argv[0]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "--swap-interval") && i + 1 < argc)
+            opts.swapInterval = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--late-input"))
+            opts.lateInput = true;
+        else if(!strcmp(argv[i], "--low-latency")){
+            opts.lateInput = true;
+            opts.pacing = FramePacing::Fence;
+        } else if(!strcmp(argv[i], "--disk-cache") && i + 1 < argc)
+            opts.diskCacheDir = argv[++i];
+        else if(!strcmp(argv[i], "--disk-cache-size") && i + 1 < argc)
+            opts.diskCacheBudget = (size_t)atol(argv[++i]) << 20;
+        else if(!strcmp(argv[i], "--fps") && i + 1 < argc)
+            opts.sequenceFps = atof(argv[++i]);
+        else if(!strcmp(argv[i], "--windows") && i + 1 < argc)
+            windows = std::max(1, atoi(argv[++i]));
+        else if(!strcmp(argv[i], "--export") && i + 1 < argc)
+            opts.exportPath = argv[++i];
+        else if(!strcmp(argv[i], "--export-width") && i + 1 < argc)
+            opts.exportWidth = std::max(0, atoi(argv[++i]));
+        else if(!strcmp(argv[i], "--server"))
+            server = true;
+        else if(!strcmp(argv[i], "--remote"))
+            remote = true;
+        else if(!strcmp(argv[i], "--socket") && i + 1 < argc)
+            socketPath = argv[++i];
+        else if(!strcmp(argv[i], "--batch"))
+            batch = true;
+        else if(!strcmp(argv[i], "--out") && i + 1 < argc)
+            batchOpts.outDir = argv[++i];
+        else if(!strcmp(argv[i], "--size") && i + 1 < argc)
+            batchOpts.size = std::max(1, atoi(argv[++i]));
+        else if(!strcmp(argv[i], "--scale") && i + 1 < argc)
+            batchOpts.scale = (float)atof(argv[++i]);
+        else if(!strcmp(argv[i], "--format") && i + 1 < argc)
+            batchOpts.format = argv[++i];
+        else if(!strcmp(argv[i], "--quality") && i + 1 < argc)
+            batchOpts.quality = std::min(100, std::max(1, atoi(argv[++i])));
+        else if(!strcmp(argv[i], "--threads") && i + 1 < argc)
+            batchOpts.threads = (unsigned)std::max(0, atoi(argv[++i]));
+        else if(argv[i][0] == '-'){
+            usage(argv[0]);
+            return 1;
+        } else
+            args.push_back(argv[i]);
+    }
+
+    std::vector<std::string> files = Playlist::expand(args);
+    if(files.empty() && !server){
+        usage(argv[0]);
         return 1;
     }
 
-    std::string path = argv[1];
-    stbi_set_flip_vertically_on_load(true);
-    int imgW, imgH;
-    data = stbi_load(path.c_str(), &imgW, &imgH, NULL, 4);
-    if(!data){
-        std::cerr << "Failed to load image: " << path << "\n";
+    if(socketPath.empty())
+        socketPath = defaultSocketPath();
+
+    // render nodes have no display; GLFW is never initialised here
+    if(batch){
+        setMipFilter(opts.mipFilter);
+        batchOpts.memoryBudget = opts.cacheBudget;
+        return runBatch(files, batchOpts);
+    }
+
+    // a warm viewer only has to decode and upload
+    if(remote && !batch){
+        double ms = 0.0, viewerMs = 0.0;
+        std::string err;
+        if(remoteOpen(socketPath, files, ms, viewerMs, err)){
+            std::cout << "Shown by the running viewer in " << ms << " ms (" << viewerMs
+                      << " ms of it in the viewer)\n";
+            return 0;
+        }
+        if(!err.empty()){
+            std::cerr << err << "\n";
+            return 1;
+        }
+        server = true;
+    }
+
+    // decoding runs in the background while the windows come up
+    ViewerGroup viewer(opts);
+    if(!files.empty())
+        viewer.loadFiles(files);
+
+    int monitorCount = 0;
+    GLFWmonitor** monitors = nullptr;
+    for(int i = 0; i < windows; i++){
+        GLFWmonitor* monitor = i > 0 && monitorCount > 1 ? monitors[i % monitorCount] : nullptr;
+        if(!viewer.openWindow(1200, 800, monitor)){
+            glfwTerminate();
+            return 1;
+        }
+
+        if(i == 0)
+            monitors = glfwGetMonitors(&monitorCount);
+    }
+
+    // two --remote started at once race for the socket; the loser just
+    // stays a viewer of its own
+    if(server && !viewer.serve(socketPath) && !remote){
+        glfwTerminate();
         return 1;
     }
 
-    glimviewUpdateImage(data, imgW, imgH);
-    freeData(freeImage);
-    return showGlimview();
+    int ret = viewer.run();
+    glfwTerminate();
+    return ret;
 }
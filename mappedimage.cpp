@@ -0,0 +1,298 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "mappedimage.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static std::mutex rawMutex;
+static RawFormat currentRaw;
+
+bool parseRawFormat(const std::string& spec, RawFormat& fmt){
+    RawFormat f;
+    char name[16] = "rgba";
+    unsigned long long stride = 0, offset = 0;
+    int n = sscanf(spec.c_str(), "%dx%d:%15[a-z]:%llu:%llu", &f.w, &f.h, name, &stride, &offset);
+    if(n < 2 || f.w <= 0 || f.h <= 0)
+        return false;
+
+    static const struct { const char* name; int channels; bool bgr; } formats[] = {
+        {"gray", 1, false}, {"graya", 2, false}, {"rgb", 3, false},
+        {"rgba", 4, false}, {"bgr", 3, true}, {"bgra", 4, true}
+    };
+
+    bool known = false;
+    for(const auto &k : formats)
+        if(!strcmp(name, k.name)){
+            f.channels = k.channels;
+            f.bgr = k.bgr;
+            known = true;
+        }
+
+    f.stride = (size_t)stride;
+    f.offset = (size_t)offset;
+    if(!known || (f.stride && f.stride < (size_t)f.w * f.channels))
+        return false;
+
+    fmt = f;
+    return true;
+}
+
+void setRawFormat(const RawFormat& fmt){
+    std::lock_guard<std::mutex> lock(rawMutex);
+    currentRaw = fmt;
+}
+
+RawFormat rawFormat(){
+    std::lock_guard<std::mutex> lock(rawMutex);
+    return currentRaw;
+}
+
+#ifndef _WIN32
+namespace {
+
+// Where the pixels of a mapped file are and how they are laid out.
+struct Layout{
+    int w = 0, h = 0, channels = 0;
+    bool bgr = false;
+    bool topFirst = false;
+    size_t stride = 0;
+    size_t offset = 0;
+};
+
+uint32_t le16(const unsigned char* p){ return p[0] | p[1] << 8; }
+uint32_t le32(const unsigned char* p){ return le16(p) | le16(p + 2) << 16; }
+
+std::string extension(const std::string& path){
+    size_t dot = path.find_last_of('.');
+    if(dot == std::string::npos || path.find('/', dot) != std::string::npos)
+        return std::string();
+
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext;
+}
+
+// Binary PPM (P6) and PGM (P5) with maxval 255. Other depths are left to
+// stb_image, which scales them.
+bool pnmLayout(const unsigned char* p, size_t size, Layout& l){
+    if(size < 3 || p[0] != 'P' || (p[1] != '5' && p[1] != '6'))
+        return false;
+
+    size_t pos = 2;
+    long v[3];
+    for(int i = 0; i < 3; i++){
+        while(pos < size && (isspace(p[pos]) || p[pos] == '#')){
+            if(p[pos] == '#')
+                while(pos < size && p[pos] != '\n')
+                    pos++;
+            else
+                pos++;
+        }
+
+        if(pos >= size || !isdigit(p[pos]))
+            return false;
+
+        v[i] = 0;
+        while(pos < size && isdigit(p[pos]) && v[i] < 1000000)
+            v[i] = v[i] * 10 + (p[pos++] - '0');
+    }
+
+    // exactly one whitespace byte ends the header
+    if(v[2] != 255 || pos >= size || !isspace(p[pos]))
+        return false;
+
+    l.w = (int)v[0];
+    l.h = (int)v[1];
+    l.channels = p[1] == '6' ? 3 : 1;
+    l.stride = (size_t)l.w * l.channels;
+    l.offset = pos + 1;
+    l.topFirst = true;
+    return true;
+}
+
+// BI_RGB 24-bit, and 32-bit BI_BITFIELDS with the usual BGRA masks.
+// 32-bit BI_RGB has an undefined fourth byte; stb_image sorts that out.
+bool bmpLayout(const unsigned char* p, size_t size, Layout& l){
+    if(size < 54 || p[0] != 'B' || p[1] != 'M')
+        return false;
+
+    uint32_t header = le32(p + 14);
+    int32_t w = (int32_t)le32(p + 18), h = (int32_t)le32(p + 22);
+    uint32_t bpp = le16(p + 28), compression = le32(p + 30);
+    if(header < 40 || w <= 0 || h == 0 || h == INT32_MIN)
+        return false;
+
+    if(compression == 0 && bpp == 24)
+        l.channels = 3;
+    else if(compression == 3 && bpp == 32 && header >= 56 && size >= 70 &&
+            le32(p + 54) == 0x00FF0000 && le32(p + 58) == 0x0000FF00 &&
+            le32(p + 62) == 0x000000FF && le32(p + 66) == 0xFF000000)
+        l.channels = 4;
+    else
+        return false;
+
+    l.w = w;
+    l.h = std::abs(h);
+    l.bgr = true;
+    l.topFirst = h < 0;
+    l.stride = ((size_t)w * bpp + 31) / 32 * 4;
+    l.offset = le32(p + 10);
+    return true;
+}
+
+// Uncompressed true colour (24 / 32-bit with an 8-bit alpha) and 8-bit
+// gray, stored left to right. TGA has no magic; the extension decides.
+bool tgaLayout(const unsigned char* p, size_t size, Layout& l){
+    if(size < 18 || p[1] != 0)
+        return false;
+
+    int type = p[2], bpp = p[16], desc = p[17];
+    if(desc & 0x10)
+        return false;
+
+    if(type == 2 && bpp == 24)
+        l.channels = 3;
+    else if(type == 2 && bpp == 32 && (desc & 0x0F) == 8)
+        l.channels = 4;
+    else if(type == 3 && bpp == 8)
+        l.channels = 1;
+    else
+        return false;
+
+    l.w = le16(p + 12);
+    l.h = le16(p + 14);
+    l.bgr = l.channels >= 3;
+    l.topFirst = (desc & 0x20) != 0;
+    l.stride = (size_t)l.w * l.channels;
+    l.offset = 18 + p[0];
+    return l.w > 0 && l.h > 0;
+}
+
+} // namespace
+
+std::shared_ptr<Image> mapImageFile(const std::string& path, std::string& err){
+    std::string ext = extension(path);
+    bool raw = ext == ".raw";
+    RawFormat rf = rawFormat();
+    if(raw && !rf.w){
+        err = "Raw image needs --raw WxH[:format]: " + path;
+        return nullptr;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0){
+        close(fd);
+        return nullptr;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return nullptr;
+
+    const unsigned char* p = (const unsigned char*)map;
+    Layout l;
+    bool known;
+    if(raw){
+        l.w = rf.w;
+        l.h = rf.h;
+        l.channels = rf.channels;
+        l.bgr = rf.bgr;
+        l.topFirst = true;
+        l.stride = rf.stride ? rf.stride : (size_t)rf.w * rf.channels;
+        l.offset = rf.offset;
+        known = true;
+    } else {
+        known = pnmLayout(p, size, l) || bmpLayout(p, size, l) ||
+                (ext == ".tga" && tgaLayout(p, size, l));
+    }
+
+    if(!known){
+        munmap(map, size);
+        return nullptr;
+    }
+
+    // the last row only needs its pixels, not its padding
+    size_t need = l.offset + l.stride * (l.h - 1) + (size_t)l.w * l.channels;
+    if(l.w <= 0 || l.h <= 0 || l.offset > size || need > size){
+        munmap(map, size);
+        err = "Truncated or malformed image: " + path;
+        return nullptr;
+    }
+
+    // the pyramid is built in one pass from top to bottom
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    auto img = makeImage((unsigned char*)p + l.offset, l.w, l.h, l.channels,
+                         [map, size](){ munmap(map, size); });
+    img->levels[0].stride = l.stride;
+    img->bgr = l.bgr;
+    img->topFirst = l.topFirst;
+    if(l.topFirst)
+        img->orientation = Orientation::flipY();
+    img->readOnly = true;
+    return img;
+}
+
+void releaseMappedRows(const Image& img, int rows){
+    if(!img.readOnly || img.levels.empty() || rows <= 0)
+        return;
+
+    // whole pages only; one shared with a row still to come stays
+    const ImageLevel& lv = img.levels[0];
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)lv.pixels & ~(page - 1);
+    uintptr_t end = (uintptr_t)lv.pixels + lv.stride * (std::min(rows, lv.h) - 1) + (size_t)lv.w * img.channels;
+    if(rows < lv.h)
+        end &= ~(page - 1);
+    if(end <= start)
+        return;
+
+    madvise((void*)start, end - start, MADV_DONTNEED);
+    if(rows >= lv.h)
+        madvise((void*)start, end - start, MADV_NORMAL);
+}
+#else
+std::shared_ptr<Image> mapImageFile(const std::string&, std::string&){
+    return nullptr;
+}
+
+void releaseMappedRows(const Image&, int){
+}
+#endif
@@ -0,0 +1,61 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef MAPPEDIMAGE_H
+#define MAPPEDIMAGE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "image.hpp"
+
+// Layout of headerless raw dumps (.raw files). They carry nothing to read
+// it from, so it comes from the command line.
+struct RawFormat{
+    int w = 0, h = 0;               // 0 until given
+    int channels = 4;
+    bool bgr = false;
+    size_t stride = 0;              // bytes per row, 0 for w * channels
+    size_t offset = 0;              // bytes before the first row
+};
+
+// "WxH[:format[:stride[:offset]]]", format one of gray, graya, rgb,
+// rgba, bgr or bgra (default rgba). Rows are top first.
+bool parseRawFormat(const std::string& spec, RawFormat& fmt);
+// Layout used for .raw files loaded from now on.
+void setRawFormat(const RawFormat& fmt);
+RawFormat rawFormat();
+
+// Maps path read-only and returns an image whose level 0 is the mapped
+// pixels, with no decode and no copy, for files that need no decoding:
+// binary PPM / PGM with 8-bit samples, uncompressed 24 / 32-bit BMP and
+// TGA, 8-bit gray TGA and raw dumps. nullptr with err empty for anything
+// else (stb_image's job); nullptr with err set for a file that claims
+// one of these formats but is truncated or malformed.
+std::shared_ptr<Image> mapImageFile(const std::string& path, std::string& err);
+
+// Drops the pages of level 0 rows [0, rows) of a mapped image from the
+// resident set, for buildPyramid's consumed. They stay in the page cache
+// for tile uploads; once all rows are done, reads go back to normal
+// read-ahead.
+void releaseMappedRows(const Image& img, int rows);
+
+#endif // MAPPEDIMAGE_H
@@ -0,0 +1,94 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "minimap.hpp"
+#include "tiledimage.hpp"
+
+void Minimap::init(GLuint program){
+    locRect = glGetUniformLocation(program, "uRect");
+    locUVRect = glGetUniformLocation(program, "uUVRect");
+}
+
+void Minimap::destroy(){
+    glDeleteTextures(1, &tex);
+    tex = 0;
+    imgW = imgH = 0;
+}
+
+void Minimap::setImage(const std::shared_ptr<Image>& img){
+    if(!img || !img->thumbnail.pixels){
+        imgW = imgH = 0;
+        return;
+    }
+
+    const ImageLevel& thumb = img->thumbnail;
+    if(!tex){
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    // a few hundred KB at most, uploaded directly
+    GLint internal;
+    GLenum fmt;
+    textureFormat(img->channels, internal, fmt);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)(thumb.stride / img->channels));
+    glTexImage2D(GL_TEXTURE_2D, 0, internal, thumb.w, thumb.h, 0, fmt,
+                 GL_UNSIGNED_BYTE, thumb.pixels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    textureSwizzle(img->channels, img->bgr);
+
+    imgW = img->w;
+    imgH = img->h;
+}
+
+void Minimap::update(const Image& img, const ImageRect& r){
+    if(!imgW || r.empty())
+        return;
+
+    const ImageLevel& thumb = img.thumbnail;
+    GLint internal;
+    GLenum fmt;
+    textureFormat(img.channels, internal, fmt);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)(thumb.stride / img.channels));
+    glTexSubImage2D(GL_TEXTURE_2D, 0, r.x0, r.y0, r.x1 - r.x0, r.y1 - r.y0, fmt,
+                    GL_UNSIGNED_BYTE, thumb.pixels + r.y0 * thumb.stride + (size_t)r.x0 * img.channels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void Minimap::draw(GLuint quadVAO) const {
+    if(!imgW)
+        return;
+
+    glUniform4f(locRect, 0.0f, 0.0f, (float)imgW, (float)imgH);
+    glUniform4f(locUVRect, 0.0f, 0.0f, 1.0f, 1.0f);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glBindVertexArray(quadVAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+}
@@ -0,0 +1,56 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <glad/glad.h>
+#include <memory>
+#include "image.hpp"
+
+// Bird's-eye view of the current image. Draws the image's thumbnail from
+// one small texture of its own, so the minimap costs the same for any
+// image size and never depends on which tiles are resident.
+class Minimap{
+public:
+    // Largest thumbnail side; comfortably above the 220 pixel minimap.
+    static constexpr int thumbnailSize = 256;
+
+    // Caches the uRect / uUVRect uniform locations of the tile program.
+    void init(GLuint program);
+    void destroy();
+
+    // Uploads the thumbnail of img, or clears it when img is null.
+    void setImage(const std::shared_ptr<Image>& img);
+    // Re-uploads the part r of img's thumbnail after updateRegion.
+    void update(const Image& img, const ImageRect& r);
+
+    // Draws the whole image at the origin of the current image space; the
+    // tile program must be bound with uProj / uPan / uZoom already set.
+    void draw(GLuint quadVAO) const;
+
+private:
+    GLuint tex = 0;
+    GLint locRect = -1, locUVRect = -1;
+    int imgW = 0, imgH = 0;
+};
+
+#endif // MINIMAP_H
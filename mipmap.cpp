@@ -0,0 +1,497 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "mipmap.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIPMAP_SSE2 1
+#endif
+
+// AVX2 code is compiled with a target attribute and picked at run time, so
+// the binary still runs on CPUs without it.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MIPMAP_AVX2 1
+#define MIPMAP_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+static std::atomic<MipFilter> currentFilter{MipFilter::Kaiser};
+
+void setMipFilter(MipFilter filter){
+    currentFilter = filter;
+}
+
+MipFilter mipFilter(){
+    return currentFilter;
+}
+
+bool parseMipFilter(const std::string& name, MipFilter& filter){
+    if(name == "box")
+        filter = MipFilter::Box;
+    else if(name == "kaiser")
+        filter = MipFilter::Kaiser;
+    else if(name == "lanczos")
+        filter = MipFilter::Lanczos;
+    else
+        return false;
+
+    return true;
+}
+
+// Never destroyed: loader threads may still be building a pyramid while
+// static destructors run at exit, and a destroyed pool would drop their
+// bands and leave them waiting forever.
+ThreadPool& mipWorkers(){
+    static ThreadPool* pool = new ThreadPool;
+    return *pool;
+}
+
+namespace {
+
+// Decoding to linear is a lookup on the byte, with alpha in the upper half
+// of the table so a whole RGBA row goes through one gather. Encoding looks
+// up 16 bits of linear value, enough to keep every sRGB code near black.
+struct Tables{
+    float toLinear[512];
+    unsigned char toSrgb[65536];
+
+    Tables(){
+        for(int i = 0; i < 256; i++){
+            double s = i / 255.0;
+            toLinear[i] = (float)(s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4));
+            toLinear[256 + i] = (float)s;
+        }
+
+        for(int i = 0; i < 65536; i++){
+            double l = i / 65535.0;
+            double s = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+            toSrgb[i] = (unsigned char)std::min(255.0, s * 255.0 + 0.5);
+        }
+    }
+};
+
+const Tables& tables(){
+    static Tables t;
+    return t;
+}
+
+// Output pixel i of a 2:1 reduction is centred between source pixels 2i
+// and 2i + 1; tap t reads source pixel 2i + first + t.
+struct Kernel{
+    int taps = 2;
+    int first = 0;
+    std::vector<float> weights;
+};
+
+double sinc(double x){
+    if(std::fabs(x) < 1e-9)
+        return 1.0;
+
+    x *= 3.14159265358979323846;
+    return std::sin(x) / x;
+}
+
+double besselI0(double x){
+    double sum = 1.0, term = 1.0;
+    for(int k = 1; k < 32; k++){
+        double f = x / (2.0 * k);
+        term *= f * f;
+        sum += term;
+    }
+
+    return sum;
+}
+
+Kernel makeKernel(MipFilter filter){
+    // support radius in output pixels
+    double radius = filter == MipFilter::Box ? 0.5 : (filter == MipFilter::Kaiser ? 2.0 : 3.0);
+    const double alpha = 4.0;
+
+    Kernel k;
+    k.taps = (int)(radius * 4.0);
+    k.first = 1 - k.taps / 2;
+
+    double sum = 0.0;
+    for(int t = 0; t < k.taps; t++){
+        double x = (k.first + t - 0.5) / 2.0;
+        double w = 1.0;
+        if(filter == MipFilter::Kaiser){
+            double r = x / radius;
+            w = sinc(x) * besselI0(alpha * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(alpha);
+        } else if(filter == MipFilter::Lanczos){
+            w = sinc(x) * sinc(x / radius);
+        }
+
+        k.weights.push_back((float)w);
+        sum += w;
+    }
+
+    for(float& w : k.weights)
+        w = (float)(w / sum);
+
+    return k;
+}
+
+struct Job{
+    const ImageLevel* src;
+    ImageLevel* dst;
+    int channels;
+    int alpha;                  // channel holding alpha, -1 if none
+    Kernel kernel;
+    int x0, x1;                 // output columns written
+    int srcX0, srcX1;           // source columns they read
+    std::vector<int> columns;   // clamped source column of every tap, per output pixel,
+                                // relative to srcX0
+};
+
+#ifdef MIPMAP_AVX2
+bool hasAvx2(){
+    static const bool yes = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return yes;
+}
+
+MIPMAP_TARGET_AVX2
+void linearizeRgbaAvx2(const unsigned char* in, float* out, size_t n, const float* lut){
+    const __m256i alphaOffset = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(in + i)));
+        idx = _mm256_add_epi32(idx, alphaOffset);
+        _mm256_storeu_ps(out + i, _mm256_i32gather_ps(lut, idx, 4));
+    }
+
+    for(; i < n; i++)
+        out[i] = lut[in[i] + ((i & 3) == 3 ? 256 : 0)];
+}
+
+MIPMAP_TARGET_AVX2
+void verticalAvx2(const float* const* rows, const float* weights, int taps, float* acc, size_t n){
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m256 s = _mm256_mul_ps(_mm256_set1_ps(weights[0]), _mm256_loadu_ps(rows[0] + i));
+        for(int t = 1; t < taps; t++)
+            s = _mm256_fmadd_ps(_mm256_set1_ps(weights[t]), _mm256_loadu_ps(rows[t] + i), s);
+        _mm256_storeu_ps(acc + i, s);
+    }
+
+    for(; i < n; i++){
+        float s = 0.0f;
+        for(int t = 0; t < taps; t++)
+            s += weights[t] * rows[t][i];
+        acc[i] = s;
+    }
+}
+#endif
+
+void linearize(const Job& job, const unsigned char* in, float* out){
+    const float* lut = tables().toLinear;
+    int channels = job.channels;
+    size_t n = (size_t)(job.srcX1 - job.srcX0) * channels;
+    in += (size_t)job.srcX0 * channels;
+
+#ifdef MIPMAP_AVX2
+    if(channels == 4 && hasAvx2()){
+        linearizeRgbaAvx2(in, out, n, lut);
+        return;
+    }
+#endif
+
+    for(size_t i = 0; i < n; i += channels)
+        for(int c = 0; c < channels; c++)
+            out[i + c] = lut[in[i + c] + (c == job.alpha ? 256 : 0)];
+}
+
+void horizontal(const Job& job, const float* in, float* out){
+    const Kernel& k = job.kernel;
+    const float* w = k.weights.data();
+    const int* col = job.columns.data();
+    int channels = job.channels;
+    int width = job.x1 - job.x0;
+
+#ifdef MIPMAP_SSE2
+    if(channels == 4){
+        for(int x = 0; x < width; x++, col += k.taps){
+            __m128 s = _mm_setzero_ps();
+            for(int t = 0; t < k.taps; t++)
+                s = _mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(w[t]), _mm_loadu_ps(in + col[t] * 4)));
+            _mm_storeu_ps(out + x * 4, s);
+        }
+        return;
+    }
+#endif
+
+    for(int x = 0; x < width; x++, col += k.taps)
+        for(int c = 0; c < channels; c++){
+            float s = 0.0f;
+            for(int t = 0; t < k.taps; t++)
+                s += w[t] * in[col[t] * channels + c];
+            out[x * channels + c] = s;
+        }
+}
+
+void vertical(const float* const* rows, const float* weights, int taps, float* acc, size_t n){
+#ifdef MIPMAP_AVX2
+    if(hasAvx2()){
+        verticalAvx2(rows, weights, taps, acc, n);
+        return;
+    }
+#endif
+
+    for(size_t i = 0; i < n; i++)
+        acc[i] = weights[0] * rows[0][i];
+
+    for(int t = 1; t < taps; t++){
+        const float* r = rows[t];
+        float w = weights[t];
+        for(size_t i = 0; i < n; i++)
+            acc[i] += w * r[i];
+    }
+}
+
+void encode(const Job& job, const float* in, unsigned char* out){
+    const unsigned char* lut = tables().toSrgb;
+    int channels = job.channels;
+    size_t n = (size_t)(job.x1 - job.x0) * channels;
+    out += (size_t)job.x0 * channels;
+
+#ifdef MIPMAP_SSE2
+    if(channels == 4){
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_setr_ps(65535.0f, 65535.0f, 65535.0f, 255.0f);
+        alignas(16) int q[4];
+        for(size_t i = 0; i < n; i += 4){
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), zero), one);
+            _mm_store_si128((__m128i*)q, _mm_cvtps_epi32(_mm_mul_ps(v, scale)));
+            out[i + 0] = lut[q[0]];
+            out[i + 1] = lut[q[1]];
+            out[i + 2] = lut[q[2]];
+            out[i + 3] = (unsigned char)q[3];
+        }
+        return;
+    }
+#endif
+
+    for(size_t i = 0; i < n; i += channels)
+        for(int c = 0; c < channels; c++){
+            float v = std::min(std::max(in[i + c], 0.0f), 1.0f);
+            out[i + c] = c == job.alpha ? (unsigned char)(v * 255.0f + 0.5f)
+                                        : lut[(int)(v * 65535.0f + 0.5f)];
+        }
+}
+
+// Output rows [y0, y1). Horizontally filtered source rows live in a ring
+// of `taps` slots, so each one is computed once per band as the vertical
+// window slides down two rows at a time.
+void runBand(const Job& job, int y0, int y1){
+    const Kernel& k = job.kernel;
+    const ImageLevel& src = *job.src;
+    const ImageLevel& dst = *job.dst;
+    size_t n = (size_t)(job.x1 - job.x0) * job.channels;
+
+    std::vector<float> lin((size_t)(job.srcX1 - job.srcX0) * job.channels);
+    std::vector<float> ring(n * k.taps);
+    std::vector<float> acc(n);
+    std::vector<int> slotRow(k.taps, INT_MIN);
+    std::vector<const float*> rows(k.taps);
+
+    for(int y = y0; y < y1; y++){
+        for(int t = 0; t < k.taps; t++){
+            int r = 2 * y + k.first + t;
+            int slot = ((r % k.taps) + k.taps) % k.taps;
+            float* row = ring.data() + slot * n;
+            if(slotRow[slot] != r){
+                int sy = std::min(std::max(r, 0), src.h - 1);
+                linearize(job, src.pixels + sy * src.stride, lin.data());
+                horizontal(job, lin.data(), row);
+                slotRow[slot] = r;
+            }
+            rows[t] = row;
+        }
+
+        vertical(rows.data(), k.weights.data(), k.taps, acc.data(), n);
+        encode(job, acc.data(), dst.pixels + y * dst.stride);
+    }
+}
+
+} // namespace
+
+void downsampleLevel(const ImageLevel& src, ImageLevel& dst, int channels, MipFilter filter){
+    downsampleRegion(src, dst, channels, filter, 0, 0, dst.w, dst.h);
+}
+
+void downsampleRegion(const ImageLevel& src, ImageLevel& dst, int channels, MipFilter filter,
+                      int x0, int y0, int x1, int y1){
+    if(x1 <= x0 || y1 <= y0)
+        return;
+
+    Job job;
+    job.src = &src;
+    job.dst = &dst;
+    job.channels = channels;
+    job.alpha = (channels == 2 || channels == 4) ? channels - 1 : -1;
+    job.kernel = makeKernel(filter);
+    job.x0 = x0;
+    job.x1 = x1;
+
+    int taps = job.kernel.taps;
+    job.srcX0 = std::max(2 * x0 + job.kernel.first, 0);
+    job.srcX1 = std::min(2 * (x1 - 1) + job.kernel.first + taps, src.w);
+    job.columns.resize((size_t)(x1 - x0) * taps);
+    for(int x = x0; x < x1; x++)
+        for(int t = 0; t < taps; t++)
+            job.columns[(x - x0) * taps + t] =
+                std::min(std::max(2 * x + job.kernel.first + t, 0), src.w - 1) - job.srcX0;
+
+    // a band recomputes the taps - 2 source rows it shares with the band
+    // above, so bands stay several times taller than the kernel
+    ThreadPool& pool = mipWorkers();
+    int rows = y1 - y0;
+    int bandRows = std::max(32, rows / (int)(pool.size() * 4));
+    int bands = (rows + bandRows - 1) / bandRows;
+    if(bands <= 1 || (size_t)(x1 - x0) * rows < 65536){
+        runBand(job, y0, y1);
+        return;
+    }
+
+    std::mutex mutex;
+    std::condition_variable done;
+    int remaining = bands;
+    for(int b = 0; b < bands; b++){
+        int by0 = y0 + b * bandRows;
+        int by1 = std::min(y1, by0 + bandRows);
+        pool.submit([&, by0, by1](){
+            runBand(job, by0, by1);
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--remaining == 0)
+                done.notify_all();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&](){ return remaining == 0; });
+}
+
+void mipFootprint(MipFilter filter, const ImageLevel& dst, int& x0, int& y0, int& x1, int& y1){
+    // output pixel i reads source pixels 2i + first .. 2i + first + taps - 1,
+    // and clamping at the edges only ever pulls in pixels already inside
+    Kernel k = makeKernel(filter);
+    auto lo = [&](int v){ return (v - k.first - k.taps + 1) >> 1; };
+    auto hi = [&](int v){ return ((v - 1 - k.first) >> 1) + 1; };
+    x0 = std::max(lo(x0), 0);
+    y0 = std::max(lo(y0), 0);
+    x1 = std::min(hi(x1), dst.w);
+    y1 = std::min(hi(y1), dst.h);
+}
+
+// Tap lists for one axis: output i covers source pixels around
+// (i + 0.5) * scale - 0.5, weighted by a tent as wide as the scale.
+static void tentTaps(int srcN, int dstN, std::vector<int>& first, std::vector<int>& count,
+                     std::vector<float>& weights){
+    float scale = (float)srcN / dstN;
+    float radius = std::max(1.0f, scale);
+    int maxTaps = (int)std::ceil(radius) * 2 + 1;
+    first.resize(dstN);
+    count.resize(dstN);
+    weights.assign((size_t)dstN * maxTaps, 0.0f);
+    for(int i = 0; i < dstN; i++){
+        float c = (i + 0.5f) * scale - 0.5f;
+        int lo = std::max(0, (int)std::ceil(c - radius));
+        int hi = std::min(srcN - 1, (int)std::floor(c + radius));
+        float* w = &weights[(size_t)i * maxTaps];
+        float total = 0.0f;
+        int n = 0;
+        for(int s = lo; s <= hi && n < maxTaps; s++, n++){
+            w[n] = std::max(0.0f, 1.0f - std::fabs(s - c) / radius);
+            total += w[n];
+        }
+
+        // an edge pixel can land between taps; it takes the nearest one
+        if(total <= 0.0f){
+            lo = std::min(std::max((int)std::lround(c), 0), srcN - 1);
+            n = 1;
+            w[0] = total = 1.0f;
+        }
+
+        for(int t = 0; t < n; t++)
+            w[t] /= total;
+        first[i] = lo;
+        count[i] = n;
+    }
+}
+
+void resizeLevel(const ImageLevel& src, ImageLevel& dst, int channels){
+    const Tables& t = tables();
+    int alpha = (channels == 2 || channels == 4) ? channels - 1 : -1;
+    std::vector<int> xFirst, xCount, yFirst, yCount;
+    std::vector<float> xWeights, yWeights;
+    tentTaps(src.w, dst.w, xFirst, xCount, xWeights);
+    tentTaps(src.h, dst.h, yFirst, yCount, yWeights);
+    size_t xStride = xWeights.size() / dst.w;
+    size_t yStride = yWeights.size() / dst.h;
+
+    // horizontal pass over every source row, then vertical into dst
+    size_t n = (size_t)dst.w * channels;
+    std::vector<float> rows(n * src.h);
+    std::vector<float> lin((size_t)src.w * channels);
+    for(int y = 0; y < src.h; y++){
+        const unsigned char* in = src.pixels + y * src.stride;
+        for(int i = 0; i < src.w * channels; i++)
+            lin[i] = t.toLinear[in[i] + (i % channels == alpha ? 256 : 0)];
+
+        float* out = rows.data() + y * n;
+        for(int x = 0; x < dst.w; x++){
+            const float* w = &xWeights[x * xStride];
+            for(int c = 0; c < channels; c++){
+                float s = 0.0f;
+                for(int k = 0; k < xCount[x]; k++)
+                    s += w[k] * lin[(xFirst[x] + k) * channels + c];
+                out[x * channels + c] = s;
+            }
+        }
+    }
+
+    std::vector<float> acc(n);
+    for(int y = 0; y < dst.h; y++){
+        std::fill(acc.begin(), acc.end(), 0.0f);
+        const float* w = &yWeights[y * yStride];
+        for(int k = 0; k < yCount[y]; k++){
+            const float* row = rows.data() + (yFirst[y] + k) * n;
+            for(size_t i = 0; i < n; i++)
+                acc[i] += w[k] * row[i];
+        }
+
+        unsigned char* out = dst.pixels + y * dst.stride;
+        for(size_t i = 0; i < n; i++){
+            float v = std::min(std::max(acc[i], 0.0f), 1.0f);
+            out[i] = (int)(i % channels) == alpha ? (unsigned char)(v * 255.0f + 0.5f)
+                                                  : t.toSrgb[(int)(v * 65535.0f + 0.5f)];
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include <string>
+#include "image.hpp"
+
+class ThreadPool;
+
+// Reconstruction filter used when halving a level.
+enum class MipFilter{
+    Box,        // 2x2 average
+    Kaiser,     // Kaiser-windowed sinc, 8 taps
+    Lanczos     // Lanczos-3, 12 taps
+};
+
+// Filter used by buildPyramid for every image loaded from now on.
+void setMipFilter(MipFilter filter);
+MipFilter mipFilter();
+bool parseMipFilter(const std::string& name, MipFilter& filter);
+
+// The process-wide pool the filters below split their rows across, one
+// worker per hardware thread. Other per-pixel passes share it rather than
+// start threads of their own.
+ThreadPool& mipWorkers();
+
+// Writes dst, which is src halved (rounding up), filtering the colour
+// channels in linear light and alpha as is. The rows are split across a
+// shared pool of worker threads; the call returns when dst is complete.
+void downsampleLevel(const ImageLevel& src, ImageLevel& dst, int channels, MipFilter filter);
+
+// Recomputes only dst pixels [x0, x1) x [y0, y1) of a level written by
+// downsampleLevel, for when the source changed underneath them.
+void downsampleRegion(const ImageLevel& src, ImageLevel& dst, int channels, MipFilter filter,
+                      int x0, int y0, int x1, int y1);
+
+// Writes dst from src at any size up to src's own (dst.w, dst.h and
+// dst.pixels set by the caller), with a tent filter stretched over the
+// scale factor, in linear light like the halving filters. For ratios
+// under 2:1; halve first for anything smaller. Runs on the calling thread.
+void resizeLevel(const ImageLevel& src, ImageLevel& dst, int channels);
+
+// Turns the rectangle [x0, x1) x [y0, y1) of changed source pixels into
+// the rectangle of dst pixels that read any of them.
+void mipFootprint(MipFilter filter, const ImageLevel& dst, int& x0, int& y0, int& x1, int& y1);
+
+#endif // MIPMAP_H
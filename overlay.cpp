@@ -0,0 +1,122 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "overlay.hpp"
+#include "shader.hpp"
+#include <cmath>
+
+static const char* overlay_vs = R"(
+#version 330 core
+layout(location=0) in vec2 aPos;
+layout(location=1) in vec4 aColor;
+uniform mat4 uProj;
+out vec4 vColor;
+void main(){
+    gl_Position = uProj * vec4(aPos.xy, 0.0, 1.0);
+    vColor = aColor;
+}
+)";
+
+static const char* overlay_fs = R"(
+#version 330 core
+in vec4 vColor;
+out vec4 FragColor;
+void main(){ FragColor = vColor; }
+)";
+
+void Overlay::init(){
+    GLuint vs = compileShader(GL_VERTEX_SHADER, overlay_vs);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, overlay_fs);
+    program = linkProgram(vs, fs);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    locProj = glGetUniformLocation(program, "uProj");
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
+    glBindVertexArray(0);
+}
+
+void Overlay::destroy(){
+    glDeleteProgram(program);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    batch.clear();
+    capacity = 0;
+}
+
+void Overlay::quad(float x0, float y0, float x1, float y1,
+                   float x2, float y2, float x3, float y3, Color c){
+    Vertex v[6] = {
+        {x0, y0, c}, {x1, y1, c}, {x2, y2, c},
+        {x2, y2, c}, {x3, y3, c}, {x0, y0, c}
+    };
+    batch.insert(batch.end(), v, v + 6);
+}
+
+void Overlay::rect(float x0, float y0, float x1, float y1, Color c){
+    quad(x0, y0, x1, y0, x1, y1, x0, y1, c);
+}
+
+void Overlay::frame(float x0, float y0, float x1, float y1, float width, Color c){
+    rect(x0, y0, x1, y0 + width, c);
+    rect(x0, y1 - width, x1, y1, c);
+    rect(x0, y0 + width, x0 + width, y1 - width, c);
+    rect(x1 - width, y0 + width, x1, y1 - width, c);
+}
+
+void Overlay::line(float x0, float y0, float x1, float y1, float width, Color c){
+    float dx = x1 - x0, dy = y1 - y0;
+    float len = sqrtf(dx * dx + dy * dy);
+    if(len <= 0.0f)
+        return;
+
+    float nx = -dy / len * width * 0.5f;
+    float ny = dx / len * width * 0.5f;
+    quad(x0 + nx, y0 + ny, x1 + nx, y1 + ny, x1 - nx, y1 - ny, x0 - nx, y0 - ny, c);
+}
+
+void Overlay::flush(const float* proj){
+    if(batch.empty())
+        return;
+
+    size_t size = batch.size() * sizeof(Vertex);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if(size > capacity)
+        capacity = size * 2;
+
+    // orphan last frame's storage instead of waiting for the GPU to finish
+    // reading it
+    glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, batch.data());
+
+    glUseProgram(program);
+    glUniformMatrix4fv(locProj, 1, GL_FALSE, proj);
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)batch.size());
+    batch.clear();
+}
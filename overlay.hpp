@@ -0,0 +1,66 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+struct Color{
+    float r, g, b, a;
+};
+
+// Retained renderer for flat-coloured 2D overlays (minimap frame, viewport
+// rectangle, grids, selections, ...). Primitives are collected into one
+// CPU-side batch and drawn with a single draw call per flush(), from one
+// vertex buffer that is orphaned and refilled every frame, so the GL cost
+// does not grow with the number of overlay elements.
+class Overlay{
+public:
+    void init();
+    void destroy();
+
+    void rect(float x0, float y0, float x1, float y1, Color c);
+    void frame(float x0, float y0, float x1, float y1, float width, Color c);
+    void line(float x0, float y0, float x1, float y1, float width, Color c);
+
+    // Draws everything queued since the last flush with the given
+    // projection, then empties the batch.
+    void flush(const float* proj);
+
+private:
+    struct Vertex{
+        float x, y;
+        Color c;
+    };
+
+    void quad(float x0, float y0, float x1, float y1,
+              float x2, float y2, float x3, float y3, Color c);
+
+    std::vector<Vertex> batch;
+    GLuint vao = 0, vbo = 0, program = 0;
+    GLint locProj = -1;
+    size_t capacity = 0;
+};
+
+#endif // OVERLAY_H
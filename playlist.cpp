@@ -0,0 +1,228 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "playlist.hpp"
+#include "loader.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+std::shared_ptr<Image> ImageCache::get(const std::string& path){
+    auto it = entries.find(path);
+    if(it == entries.end())
+        return nullptr;
+
+    lru.splice(lru.begin(), lru, it->second.lru);
+    return it->second.image;
+}
+
+void ImageCache::put(const std::string& path, std::shared_ptr<Image> img){
+    if(entries.count(path))
+        return;
+
+    used += img->bytes();
+    lru.push_front(path);
+    entries[path] = Entry{std::move(img), lru.begin()};
+
+    // the newest entry always stays, even if it alone is over budget
+    while(used > budget && lru.size() > 1){
+        auto it = entries.find(lru.back());
+        used -= it->second.image->bytes();
+        entries.erase(it);
+        lru.pop_back();
+    }
+}
+
+Playlist::~Playlist(){
+    pool.clear();
+}
+
+void Playlist::setFiles(std::vector<std::string> f){
+    std::lock_guard<std::mutex> lock(mutex);
+    files = std::move(f);
+    current = -1;
+}
+
+void Playlist::setBudget(size_t bytes){
+    std::lock_guard<std::mutex> lock(mutex);
+    cache.setBudget(bytes);
+}
+
+bool Playlist::seek(int index){
+    std::lock_guard<std::mutex> lock(mutex);
+    int n = (int)files.size();
+    if(n == 0)
+        return false;
+
+    current = ((index % n) + n) % n;
+    delivered = false;
+    switching = true;
+    switchStart = std::chrono::steady_clock::now();
+    if(cache.contains(files[current]))
+        counters.hits++;
+    else
+        counters.misses++;
+
+    schedule();
+    return true;
+}
+
+bool Playlist::step(int delta){
+    return seek(current + delta);
+}
+
+void Playlist::schedule(){
+    // nearest first, the image being switched to before everything else;
+    // anything still queued for the old position is stale
+    pool.clear();
+    queued.clear();
+    int n = (int)files.size();
+    for(int d = 0; d <= prefetch && d < n; d++){
+        for(int sign : {1, -1}){
+            if(d == 0 && sign < 0)
+                continue;
+
+            int i = ((current + sign * d) % n + n) % n;
+            const std::string &path = files[i];
+            if(cache.contains(path) || inFlight.count(path) || queued.count(path) || errors.count(path))
+                continue;
+
+            queued.insert(path);
+            pool.submit([this, i, path](){ decode(i, path); });
+        }
+    }
+}
+
+void Playlist::decode(int index, const std::string& path){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.erase(path);
+        int n = (int)files.size();
+        int dist = std::abs(index - current);
+        if(std::min(dist, n - dist) > prefetch || inFlight.count(path) || cache.contains(path))
+            return;
+
+        inFlight.insert(path);
+    }
+
+    std::string err;
+    std::shared_ptr<Image> img = decodeImage(path, err);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight.erase(path);
+        if(img)
+            cache.put(path, img);
+        else
+            errors[path] = err;
+    }
+
+    if(notify)
+        notify();
+}
+
+std::shared_ptr<Image> Playlist::poll(){
+    std::lock_guard<std::mutex> lock(mutex);
+    if(delivered || current < 0)
+        return nullptr;
+
+    std::shared_ptr<Image> img = cache.get(files[current]);
+    if(img)
+        delivered = true;
+
+    return img;
+}
+
+bool Playlist::failed(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return current >= 0 && errors.count(files[current]);
+}
+
+std::string Playlist::error(){
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = current >= 0 ? errors.find(files[current]) : errors.end();
+    return it == errors.end() ? std::string() : it->second;
+}
+
+void Playlist::displayed(){
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!switching)
+        return;
+
+    switching = false;
+    counters.switchMs.push_back(std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - switchStart).count());
+}
+
+Playlist::Stats Playlist::stats(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+static bool isImageFile(const fs::path& p){
+    static const char* exts[] = {
+        ".png", ".jpg", ".jpeg", ".bmp", ".tga", ".gif", ".psd",
+        ".hdr", ".pic", ".pnm", ".ppm", ".pgm", ".raw"
+    };
+
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    for(const char* e : exts)
+        if(ext == e)
+            return true;
+
+    return false;
+}
+
+std::vector<std::string> Playlist::expand(const std::vector<std::string>& args){
+    std::vector<std::string> out;
+    for(const std::string &arg : args){
+        // @file reads one path per line
+        if(!arg.empty() && arg[0] == '@'){
+            std::ifstream in(arg.substr(1));
+            std::string line;
+            while(std::getline(in, line))
+                if(!line.empty())
+                    out.push_back(line);
+
+            continue;
+        }
+
+        std::error_code ec;
+        if(!fs::is_directory(arg, ec)){
+            out.push_back(arg);
+            continue;
+        }
+
+        std::vector<std::string> dir;
+        for(const auto &e : fs::directory_iterator(arg, ec))
+            if(e.is_regular_file(ec) && isImageFile(e.path()))
+                dir.push_back(e.path().string());
+
+        std::sort(dir.begin(), dir.end());
+        out.insert(out.end(), dir.begin(), dir.end());
+    }
+
+    return out;
+}
@@ -0,0 +1,122 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "image.hpp"
+#include "threadpool.hpp"
+
+// Byte-bounded LRU cache of decoded images keyed by path.
+class ImageCache{
+public:
+    void setBudget(size_t bytes) { budget = bytes; }
+    std::shared_ptr<Image> get(const std::string& path);
+    void put(const std::string& path, std::shared_ptr<Image> img);
+    bool contains(const std::string& path) const { return entries.count(path) != 0; }
+    size_t usedBytes() const { return used; }
+
+private:
+    struct Entry{
+        std::shared_ptr<Image> image;
+        std::list<std::string>::iterator lru;
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru;         // front = most recently used
+    size_t budget = size_t(1024) << 20;
+    size_t used = 0;
+};
+
+// An ordered list of images to step through. The images around the
+// current one are decoded ahead of time on a thread pool, so that moving
+// to the next or previous image is normally a cache hit.
+class Playlist{
+public:
+    struct Stats{
+        unsigned hits = 0, misses = 0;
+        std::vector<double> switchMs;
+    };
+
+    ~Playlist();
+
+    void setFiles(std::vector<std::string> files);
+    void setPrefetch(int count) { prefetch = count; }
+    void setBudget(size_t bytes);
+    // Called from a pool thread whenever a decode finishes.
+    void setNotify(std::function<void()> fn) { notify = std::move(fn); }
+
+    // Moves the current position by delta (wrapping) and starts prefetching
+    // around it. Returns false if the list is empty.
+    bool step(int delta);
+    bool seek(int index);
+
+    // Returns the current image once it is decoded, exactly once per step.
+    std::shared_ptr<Image> poll();
+    // True if the current image could not be decoded; error() says why.
+    bool failed();
+    std::string error();
+
+    // Called by the viewer once the image handed out by poll() is on
+    // screen; closes the switch latency measurement.
+    void displayed();
+
+    int index() const { return current; }
+    int size() const { return (int)files.size(); }
+    const std::string& path() const { return files[current]; }
+    Stats stats();
+
+    // Expands directories into their image files, sorted by name.
+    static std::vector<std::string> expand(const std::vector<std::string>& args);
+
+private:
+    void schedule();
+    void decode(int index, const std::string& path);
+
+    std::vector<std::string> files;
+    int current = -1;
+    int prefetch = 2;
+
+    std::mutex mutex;
+    ImageCache cache;
+    std::set<std::string> queued;       // submitted to the pool, not started
+    std::set<std::string> inFlight;     // being decoded
+    std::unordered_map<std::string, std::string> errors;
+    bool delivered = false;
+    bool switching = false;
+    std::chrono::steady_clock::time_point switchStart;
+    Stats counters;
+    std::function<void()> notify;
+
+    // last so its workers are joined before the state they touch goes away
+    ThreadPool pool;
+};
+
+#endif // PLAYLIST_H
@@ -0,0 +1,298 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "profiler.hpp"
+#include "overlay.hpp"
+#include <algorithm>
+#include <iostream>
+
+static const Color phaseColors[FrameProfiler::PhaseCount] = {
+    {0.55f, 0.55f, 0.70f, 0.9f},    // Events
+    {0.95f, 0.80f, 0.25f, 0.9f},    // Spring
+    {0.35f, 0.80f, 0.40f, 0.9f},    // Main
+    {0.30f, 0.75f, 0.90f, 0.9f},    // Minimap
+    {0.90f, 0.35f, 0.30f, 0.9f},    // Swap
+};
+
+const char* FrameProfiler::phaseName(Phase p){
+    static const char* names[PhaseCount] = { "events", "spring", "main", "minimap", "swap" };
+    return names[p];
+}
+
+void FrameProfiler::init(){
+    start = Clock::now();
+    for(QuerySet &qs : ring)
+        glGenQueries(PhaseCount, qs.q);
+}
+
+void FrameProfiler::destroy(){
+    // leaves the profiler ready for another init()
+    for(QuerySet &qs : ring){
+        glDeleteQueries(PhaseCount, qs.q);
+        qs = QuerySet();
+    }
+
+    frames.assign(history, Frame());
+    ringPos = 0;
+    count = 0;
+    active = nullptr;
+
+    if(trace){
+        if(json)
+            fputs("\n]\n", trace);
+
+        fclose(trace);
+        trace = nullptr;
+    }
+}
+
+bool FrameProfiler::openTrace(const std::string& path){
+    trace = fopen(path.c_str(), "w");
+    if(!trace){
+        std::cerr << "Cannot open trace file: " << path << "\n";
+        return false;
+    }
+
+    json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    if(json){
+        fputs("[", trace);
+        return true;
+    }
+
+    fputs("frame,time_ms", trace);
+    for(int p = 0; p < PhaseCount; p++)
+        fprintf(trace, ",cpu_%s_ms", phaseName((Phase)p));
+
+    for(int p = 0; p < PhaseCount; p++)
+        if(gpuPhase((Phase)p))
+            fprintf(trace, ",gpu_%s_ms", phaseName((Phase)p));
+
+    fputs("\n", trace);
+    return true;
+}
+
+void FrameProfiler::writeTrace(const Frame& f){
+    if(!trace)
+        return;
+
+    if(json){
+        fprintf(trace, "%s\n  {\"frame\": %lu, \"time_ms\": %.3f, \"cpu\": {",
+                firstRow ? "" : ",", f.index, f.time);
+        for(int p = 0; p < PhaseCount; p++)
+            fprintf(trace, "%s\"%s\": %.4f", p ? ", " : "", phaseName((Phase)p), f.cpu[p]);
+
+        fputs("}, \"gpu\": {", trace);
+        bool first = true;
+        for(int p = 0; p < PhaseCount; p++){
+            if(!gpuPhase((Phase)p) || !f.gpuValid)
+                continue;
+
+            fprintf(trace, "%s\"%s\": %.4f", first ? "" : ", ", phaseName((Phase)p), f.gpu[p]);
+            first = false;
+        }
+
+        fputs("}}", trace);
+        firstRow = false;
+        return;
+    }
+
+    fprintf(trace, "%lu,%.3f", f.index, f.time);
+    for(int p = 0; p < PhaseCount; p++)
+        fprintf(trace, ",%.4f", f.cpu[p]);
+
+    for(int p = 0; p < PhaseCount; p++){
+        if(!gpuPhase((Phase)p))
+            continue;
+
+        if(f.gpuValid)
+            fprintf(trace, ",%.4f", f.gpu[p]);
+        else
+            fputs(",", trace);
+    }
+
+    fputs("\n", trace);
+}
+
+void FrameProfiler::collect(){
+    for(QuerySet &qs : ring){
+        if(!qs.pending)
+            continue;
+
+        // queries complete in order, so the last one used in the frame
+        // being available means all of them are
+        int last = -1;
+        for(int p = 0; p < PhaseCount; p++)
+            if(qs.used[p])
+                last = p;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(qs.q[last], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available)
+            continue;
+
+        Frame &f = frames[qs.frame];
+        for(int p = 0; p < PhaseCount; p++){
+            if(!qs.used[p])
+                continue;
+
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(qs.q[p], GL_QUERY_RESULT, &ns);
+            f.gpu[p] = ns / 1e6;
+        }
+
+        f.gpuValid = true;
+        qs.pending = false;
+        writeTrace(f);
+    }
+}
+
+void FrameProfiler::beginFrame(){
+    collect();
+
+    current = Frame();
+    current.index = count;
+    current.time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // a slot whose results are still outstanding after a full trip around
+    // the ring is given up rather than waited for
+    QuerySet &qs = ring[ringPos];
+    if(qs.pending){
+        qs.pending = false;
+        writeTrace(frames[qs.frame]);
+    }
+
+    std::fill(qs.used, qs.used + PhaseCount, false);
+    active = &qs;
+}
+
+void FrameProfiler::begin(Phase p){
+    phaseStart[p] = Clock::now();
+    if(gpuPhase(p) && active){
+        glBeginQuery(GL_TIME_ELAPSED, active->q[p]);
+        active->used[p] = true;
+    }
+}
+
+void FrameProfiler::end(Phase p){
+    current.cpu[p] += std::chrono::duration<double, std::milli>(Clock::now() - phaseStart[p]).count();
+    if(gpuPhase(p) && active && active->used[p])
+        glEndQuery(GL_TIME_ELAPSED);
+}
+
+void FrameProfiler::endFrame(){
+    int slot = (int)(count % history);
+    frames[slot] = current;
+    count++;
+
+    bool anyGpu = false;
+    for(int p = 0; p < PhaseCount; p++)
+        anyGpu = anyGpu || active->used[p];
+
+    if(anyGpu){
+        active->pending = true;
+        active->frame = slot;
+        ringPos = (ringPos + 1) % ringSize;
+    } else
+        writeTrace(frames[slot]);
+
+    active = nullptr;
+}
+
+void FrameProfiler::averages(double& cpuMs, double& gpuMs) const {
+    int n = (int)std::min<unsigned long>(count, history), gn = 0;
+    cpuMs = gpuMs = 0.0;
+    for(int i = 0; i < n; i++){
+        const Frame &f = frames[i];
+        for(int p = 0; p < PhaseCount; p++){
+            cpuMs += f.cpu[p];
+            gpuMs += f.gpu[p];
+        }
+
+        gn += f.gpuValid;
+    }
+
+    cpuMs = n ? cpuMs / n : 0.0;
+    gpuMs = gn ? gpuMs / gn : 0.0;
+}
+
+void FrameProfiler::printSummary() const {
+    int n = (int)std::min<unsigned long>(count, history);
+    if(n == 0)
+        return;
+
+    std::cout << "Frame timing over the last " << n << " frames (avg / max ms):\n";
+    for(int p = 0; p < PhaseCount; p++){
+        double cpuSum = 0.0, cpuMax = 0.0, gpuSum = 0.0, gpuMax = 0.0;
+        int gn = 0;
+        for(int i = 0; i < n; i++){
+            cpuSum += frames[i].cpu[p];
+            cpuMax = std::max(cpuMax, frames[i].cpu[p]);
+            if(frames[i].gpuValid){
+                gpuSum += frames[i].gpu[p];
+                gpuMax = std::max(gpuMax, frames[i].gpu[p]);
+                gn++;
+            }
+        }
+
+        std::cout << "  " << phaseName((Phase)p) << ": cpu " << cpuSum / n << " / " << cpuMax;
+        if(gpuPhase((Phase)p) && gn)
+            std::cout << ", gpu " << gpuSum / gn << " / " << gpuMax;
+
+        std::cout << "\n";
+    }
+}
+
+void FrameProfiler::drawHud(Overlay& overlay, float x, float y) const {
+    const float barW = 2.0f, graphH = 100.0f, msScale = 3.0f, gap = 6.0f;
+    const float width = history * barW;
+    int n = (int)std::min<unsigned long>(count, history);
+
+    overlay.rect(x, y, x + width, y + graphH * 2 + gap, Color{0.0f, 0.0f, 0.0f, 0.55f});
+
+    // newest frame on the right
+    for(int i = 0; i < n; i++){
+        const Frame &f = frames[(count - 1 - i) % history];
+        float bx = x + width - (i + 1) * barW;
+
+        float top = y + graphH + gap;
+        for(int p = 0; p < PhaseCount; p++){
+            float h = std::min((float)f.cpu[p] * msScale, y + graphH * 2 + gap - top);
+            overlay.rect(bx, top, bx + barW, top + h, phaseColors[p]);
+            top += h;
+        }
+
+        if(!f.gpuValid)
+            continue;
+
+        float bottom = y;
+        for(int p = 0; p < PhaseCount; p++){
+            float h = std::min((float)f.gpu[p] * msScale, y + graphH - bottom);
+            overlay.rect(bx, bottom, bx + barW, bottom + h, phaseColors[p]);
+            bottom += h;
+        }
+    }
+
+    // 60 Hz budget marker in both graphs
+    Color mark{1.0f, 1.0f, 1.0f, 0.5f};
+    float budget = 1000.0f / 60.0f * msScale;
+    overlay.line(x, y + budget, x + width, y + budget, 1.0f, mark);
+    overlay.line(x, y + graphH + gap + budget, x + width, y + graphH + gap + budget, 1.0f, mark);
+}
@@ -0,0 +1,98 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class Overlay;
+
+// Per-frame CPU phase timings plus GPU timings from GL_TIME_ELAPSED
+// queries. GPU results are collected from a ring of query sets a few
+// frames later, whenever the driver reports them available, so reading
+// them never stalls the pipeline.
+class FrameProfiler{
+public:
+    enum Phase{ Events, Spring, Main, Minimap, Swap, PhaseCount };
+    static const int history = 240;
+    static const int ringSize = 4;
+
+    void init();
+    void destroy();
+    // Opens a CSV trace, or a JSON one if path ends in ".json".
+    bool openTrace(const std::string& path);
+
+    void beginFrame();
+    void begin(Phase p);
+    void end(Phase p);
+    // Commits the frame; a frame that is begun but never ended is dropped.
+    void endFrame();
+
+    // Stacked bar graph of the recent CPU (top) and GPU (bottom) phase
+    // times, anchored at (x, y) in window coordinates.
+    void drawHud(Overlay& overlay, float x, float y) const;
+    // Averages over the recent history, for the title bar and exit summary.
+    void averages(double& cpuMs, double& gpuMs) const;
+    void printSummary() const;
+
+    static const char* phaseName(Phase p);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Frame{
+        unsigned long index = 0;
+        double time = 0.0;                // ms since init
+        double cpu[PhaseCount] = {};
+        double gpu[PhaseCount] = {};
+        bool gpuValid = false;
+    };
+
+    struct QuerySet{
+        GLuint q[PhaseCount] = {};
+        bool used[PhaseCount] = {};
+        bool pending = false;
+        int frame = -1;                   // slot in frames
+    };
+
+    static bool gpuPhase(Phase p) { return p == Main || p == Minimap; }
+    void collect();
+    void writeTrace(const Frame& f);
+
+    std::vector<Frame> frames = std::vector<Frame>(history);
+    QuerySet ring[ringSize];
+    int ringPos = 0;
+    unsigned long count = 0;
+    Frame current;
+    QuerySet* active = nullptr;
+    Clock::time_point start, phaseStart[PhaseCount];
+
+    FILE* trace = nullptr;
+    bool json = false;
+    bool firstRow = true;
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,446 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+#include "remote.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+RemoteServer::~RemoteServer(){
+    stop();
+}
+
+#ifndef _WIN32
+// Largest width or height taken in an image request.
+static const int maxRemoteSide = 1 << 16;
+
+std::string defaultSocketPath(){
+    if(const char* dir = getenv("XDG_RUNTIME_DIR"))
+        if(*dir)
+            return std::string(dir) + "/glimview.sock";
+
+    return "/tmp/glimview-" + std::to_string(getuid()) + ".sock";
+}
+
+static bool socketAddress(const std::string& path, sockaddr_un& addr){
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(path.empty() || path.size() >= sizeof(addr.sun_path))
+        return false;
+
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+static int connectTo(const sockaddr_un& addr){
+    int s = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(s >= 0 && connect(s, (const sockaddr*)&addr, sizeof(addr)) != 0){
+        close(s);
+        s = -1;
+    }
+    return s;
+}
+
+static bool sendAll(int s, const std::string& msg){
+    size_t done = 0;
+    while(done < msg.size()){
+        ssize_t n = send(s, msg.data() + done, msg.size() - done, MSG_NOSIGNAL);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            return false;
+        done += (size_t)n;
+    }
+    return true;
+}
+
+bool RemoteServer::listen(const std::string& path, std::string& err){
+    stop();
+    sockaddr_un addr;
+    if(!socketAddress(path, addr)){
+        err = "Bad socket path: " + path;
+        return false;
+    }
+
+    // whoever can connect can make the viewer read files as its user, so
+    // the socket file is created 0600 rather than chmod-ed after the fact
+    mode_t mask = umask(0177);
+    int s = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool bound = s >= 0 && bind(s, (const sockaddr*)&addr, sizeof(addr)) == 0;
+    if(s >= 0 && !bound && errno == EADDRINUSE){
+        // a viewer that died leaves its socket file behind, one that is
+        // alive still accepts connections on it
+        int probe = connectTo(addr);
+        if(probe >= 0){
+            close(probe);
+            close(s);
+            umask(mask);
+            err = "A viewer already listens on " + path;
+            return false;
+        }
+
+        unlink(path.c_str());
+        bound = bind(s, (const sockaddr*)&addr, sizeof(addr)) == 0;
+    }
+    umask(mask);
+
+    if(!bound || ::listen(s, 16) != 0 || pipe2(wake, O_CLOEXEC) != 0){
+        err = "Cannot listen on " + path + ": " + strerror(errno);
+        if(s >= 0)
+            close(s);
+        if(bound)
+            unlink(path.c_str());
+        return false;
+    }
+
+    fd = s;
+    socketPath = path;
+    worker = std::thread([this](){ run(); });
+    return true;
+}
+
+void RemoteServer::stop(){
+    if(fd < 0)
+        return;
+
+    char c = 0;
+    while(write(wake[1], &c, 1) < 0 && errno == EINTR){
+    }
+    worker.join();
+
+    close(fd);
+    close(wake[0]);
+    close(wake[1]);
+    fd = wake[0] = wake[1] = -1;
+    unlink(socketPath.c_str());
+
+    // clients still waiting see the connection close
+    std::lock_guard<std::mutex> lock(mutex);
+    for(RemoteRequest &r : queue)
+        if(r.release)
+            r.release();
+    for(int client : waiting)
+        close(client);
+    queue.clear();
+    waiting.clear();
+}
+
+// A connection whose request has not fully arrived yet.
+struct PartialRequest{
+    int client;
+    std::string text;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+void RemoteServer::run(){
+    typedef std::chrono::steady_clock Clock;
+    // requests are a few lines from a local process; every connection is
+    // read as its bytes come, so one that stalls holds up nobody else,
+    // and one that stalls or runs on for too long is dropped
+    const auto patience = std::chrono::seconds(2);
+    std::vector<PartialRequest> partial;
+    std::vector<pollfd> fds;
+    char buf[4096];
+
+    auto finish = [this](int client, const std::string& text){
+        RemoteRequest req;
+        std::string err;
+        if(!parseRequest(text, req, err)){
+            sendAll(client, "error " + err + "\n");
+            close(client);
+            return;
+        }
+
+        req.client = client;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(req));
+            waiting.push_back(client);
+        }
+
+        if(notify)
+            notify();
+    };
+
+    for(;;){
+        fds.assign({{fd, POLLIN, 0}, {wake[0], POLLIN, 0}});
+        int timeout = -1;
+        Clock::time_point now = Clock::now();
+        for(const PartialRequest &p : partial){
+            fds.push_back({p.client, POLLIN, 0});
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(p.deadline - now).count();
+            timeout = std::max(0, timeout < 0 ? (int)left : std::min(timeout, (int)left));
+        }
+
+        int n = ::poll(fds.data(), fds.size(), timeout);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n < 0 || fds[1].revents)
+            break;
+
+        // fds[2 + i] is partial[i]; the ones done are closed or queued
+        // and dropped from the list below
+        now = Clock::now();
+        size_t kept = 0;
+        for(size_t i = 0; i < partial.size(); i++){
+            PartialRequest &p = partial[i];
+            std::string err;
+            if(fds[2 + i].revents){
+                ssize_t got = recv(p.client, buf, sizeof(buf), 0);
+                if(got > 0)
+                    p.text.append(buf, (size_t)got);
+                else if(got == 0 || errno != EINTR)
+                    err = "incomplete request";
+            }
+
+            size_t end = p.text.find("\n\n");
+            if(err.empty() && end != std::string::npos){
+                finish(p.client, p.text.substr(0, end));
+                continue;
+            }
+            if(err.empty() && (p.text.size() > (1 << 20) || now >= p.deadline))
+                err = "request timed out or too long";
+            if(!err.empty()){
+                sendAll(p.client, "error " + err + "\n");
+                close(p.client);
+                continue;
+            }
+
+            if(kept != i)
+                partial[kept] = std::move(p);
+            kept++;
+        }
+        partial.resize(kept);
+
+        if(fds[0].revents & POLLIN){
+            int client = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if(client >= 0)
+                partial.push_back({client, std::string(), now + patience});
+        }
+    }
+
+    for(const PartialRequest &p : partial)
+        close(p.client);
+}
+
+bool RemoteServer::parseRequest(const std::string& text, RemoteRequest& req, std::string& err){
+    std::istringstream in(text);
+    std::string line;
+    std::getline(in, line);
+    if(line == "open"){
+        while(std::getline(in, line))
+            req.paths.push_back(line);
+
+        if(req.paths.empty()){
+            err = "no files to open";
+            return false;
+        }
+        return true;
+    }
+
+    std::istringstream words(line);
+    std::string verb, name;
+    if(!(words >> verb >> name >> req.w >> req.h) || verb != "image" || req.w <= 0 || req.h <= 0 ||
+       name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos){
+        err = "bad request: " + line;
+        return false;
+    }
+
+    // w * h * 4 must not wrap, or a small mapping would pass for the image
+    if(req.w > maxRemoteSide || req.h > maxRemoteSide ||
+       (size_t)req.w > SIZE_MAX / 4 / (size_t)req.h){
+        err = "image too large: " + std::to_string(req.w) + "x" + std::to_string(req.h);
+        return false;
+    }
+
+    int m = shm_open(name.c_str(), O_RDONLY, 0);
+    if(m < 0){
+        err = "cannot open shared memory " + name + ": " + strerror(errno);
+        return false;
+    }
+
+    // private, so edits through glimviewUpdateRegion never reach the
+    // client; the name goes at once, the pages when the image is dropped
+    size_t size = (size_t)req.w * req.h * 4;
+    struct stat st;
+    void* map = MAP_FAILED;
+    if(fstat(m, &st) == 0 && (size_t)st.st_size >= size)
+        map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, m, 0);
+    close(m);
+    shm_unlink(name.c_str());
+
+    if(map == MAP_FAILED){
+        err = "shared memory " + name + " is smaller than the image";
+        return false;
+    }
+
+    req.pixels = (unsigned char*)map;
+    req.release = [map, size](){ munmap(map, size); };
+    return true;
+}
+
+void RemoteServer::reply(int client, const std::string& line){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find(waiting.begin(), waiting.end(), client);
+        if(it == waiting.end())
+            return;
+        waiting.erase(it);
+    }
+
+    sendAll(client, line + "\n");
+    close(client);
+}
+
+// The round trip runs from before the connect to the viewer's answer,
+// which comes once the image has been drawn.
+static bool request(const std::string& path, const std::string& msg,
+                    std::chrono::steady_clock::time_point start,
+                    double& roundTripMs, double& viewerMs, std::string& err){
+    sockaddr_un addr;
+    if(!socketAddress(path, addr))
+        return false;
+
+    int s = connectTo(addr);
+    if(s < 0)
+        return false;
+
+    std::string answer;
+    char c;
+    bool sent = sendAll(s, msg);
+    while(sent && recv(s, &c, 1, 0) == 1 && c != '\n')
+        answer += c;
+    close(s);
+
+    roundTripMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    if(answer.compare(0, 3, "ok ") == 0){
+        viewerMs = atof(answer.c_str() + 3);
+        return true;
+    }
+
+    err = answer.compare(0, 6, "error ") == 0 ? answer.substr(6) :
+          "the viewer closed the connection";
+    return false;
+}
+
+bool remoteOpen(const std::string& path, const std::vector<std::string>& files,
+                double& roundTripMs, double& viewerMs, std::string& err){
+    auto start = std::chrono::steady_clock::now();
+    // the viewer was started somewhere else
+    std::string msg = "open\n";
+    for(const std::string &f : files){
+        std::error_code ec;
+        std::string abs = std::filesystem::absolute(f, ec).string();
+        if(!ec && !abs.empty() && abs.find('\n') == std::string::npos)
+            msg += abs + "\n";
+    }
+    msg += "\n";
+
+    return request(path, msg, start, roundTripMs, viewerMs, err);
+}
+
+bool remoteImage(const std::string& path, const unsigned char* rgba, int w, int h,
+                 double& roundTripMs, double& viewerMs, std::string& err){
+    auto start = std::chrono::steady_clock::now();
+    static std::atomic<unsigned> counter{0};
+    std::string name = "/glimview-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+    size_t size = (size_t)w * h * 4;
+
+    int m = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(m < 0 || ftruncate(m, (off_t)size) != 0){
+        err = "cannot create shared memory: " + std::string(strerror(errno));
+        if(m >= 0){
+            close(m);
+            shm_unlink(name.c_str());
+        }
+        return false;
+    }
+
+    void* map = mmap(nullptr, size, PROT_WRITE, MAP_SHARED, m, 0);
+    close(m);
+    if(map == MAP_FAILED){
+        err = "cannot map shared memory: " + std::string(strerror(errno));
+        shm_unlink(name.c_str());
+        return false;
+    }
+    memcpy(map, rgba, size);
+    munmap(map, size);
+
+    bool ok = request(path, "image " + name + " " + std::to_string(w) + " " + std::to_string(h) +
+                      "\n\n", start, roundTripMs, viewerMs, err);
+    // the viewer unlinks it once mapped; this is for requests that
+    // never got that far
+    shm_unlink(name.c_str());
+    return ok;
+}
+#else
+std::string defaultSocketPath(){
+    return std::string();
+}
+
+bool RemoteServer::listen(const std::string&, std::string& err){
+    err = "--server is not supported on this platform";
+    return false;
+}
+
+void RemoteServer::stop(){
+}
+
+void RemoteServer::reply(int, const std::string&){
+}
+
+bool remoteOpen(const std::string&, const std::vector<std::string>&, double&, double&,
+                std::string&){
+    return false;
+}
+
+bool remoteImage(const std::string&, const unsigned char*, int, int, double&, double&,
+                 std::string&){
+    return false;
+}
+#endif
+
+bool RemoteServer::poll(RemoteRequest& req){
+    std::lock_guard<std::mutex> lock(mutex);
+    if(queue.empty())
+        return false;
+
+    req = std::move(queue.front());
+    queue.erase(queue.begin());
+    return true;
+}
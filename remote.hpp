@@ -0,0 +1,98 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+#ifndef REMOTE_H
+#define REMOTE_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Single instance: a viewer started with --server listens on a Unix
+// domain socket, and later invocations hand it their images instead of
+// paying for GLFW, a context and shader compiles themselves. One request
+// per connection, as lines of text:
+//
+//   open\n<path>\n<path>\n...\n\n   show these files as the new list
+//   image <shm name> <w> <h>\n\n    RGBA8 rows bottom to top in POSIX
+//                                   shared memory, unlinked by the viewer
+//
+// The viewer answers once the first frame showing the image has been
+// drawn, with "ok <ms>\n" (request to that frame, as the viewer saw it)
+// or "error <message>\n".
+
+// $XDG_RUNTIME_DIR/glimview.sock, else one per user under /tmp.
+std::string defaultSocketPath();
+
+struct RemoteRequest{
+    int client = -1;                    // for RemoteServer::reply
+    std::vector<std::string> paths;
+    unsigned char* pixels = nullptr;    // a private mapping of the shared memory
+    int w = 0, h = 0;
+    std::function<void()> release;      // unmaps pixels
+};
+
+// Accepts and reads requests on a worker thread, any number of
+// connections at once; the render thread takes them with poll() and
+// answers each with reply().
+class RemoteServer{
+public:
+    ~RemoteServer();
+
+    // A socket file left by a viewer that died is replaced; one a viewer
+    // still answers on is an error.
+    bool listen(const std::string& path, std::string& err);
+    void stop();
+    bool listening() const { return fd >= 0; }
+
+    // Called from the worker when a request is queued. Set before listen().
+    void setNotify(std::function<void()> fn) { notify = std::move(fn); }
+
+    bool poll(RemoteRequest& req);
+    // Sends line and closes the client's connection.
+    void reply(int client, const std::string& line);
+
+private:
+    void run();
+    // The text of one request, up to the blank line.
+    bool parseRequest(const std::string& text, RemoteRequest& req, std::string& err);
+
+    int fd = -1;
+    int wake[2] = {-1, -1};         // stop() interrupts the worker's poll
+    std::string socketPath;
+    std::thread worker;
+    std::function<void()> notify;
+
+    std::mutex mutex;
+    std::vector<RemoteRequest> queue;
+    std::vector<int> waiting;       // clients not answered yet
+};
+
+// Client side. Both block until the viewer has drawn the image and give
+// the round trip as the client saw it and the viewer's own part of it.
+// False with err empty when no viewer listens at path.
+bool remoteOpen(const std::string& path, const std::vector<std::string>& files,
+                double& roundTripMs, double& viewerMs, std::string& err);
+bool remoteImage(const std::string& path, const unsigned char* rgba, int w, int h,
+                 double& roundTripMs, double& viewerMs, std::string& err);
+
+#endif // REMOTE_H
@@ -0,0 +1,140 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "resample.hpp"
+
+bool parseResampleFilter(const std::string& name, ResampleFilter& filter){
+    if(name == "bilinear")
+        filter = ResampleFilter::Bilinear;
+    else if(name == "nearest")
+        filter = ResampleFilter::Nearest;
+    else if(name == "bicubic")
+        filter = ResampleFilter::Bicubic;
+    else if(name == "lanczos")
+        filter = ResampleFilter::Lanczos;
+    else
+        return false;
+
+    return true;
+}
+
+const char* resampleFilterName(ResampleFilter filter){
+    switch(filter){
+        case ResampleFilter::Nearest: return "nearest";
+        case ResampleFilter::Bicubic: return "bicubic";
+        case ResampleFilter::Lanczos: return "lanczos";
+        default: return "bilinear";
+    }
+}
+
+// Texel i is centred on i + 0.5. The kernels are separable and their
+// weights are normalised, so clamping the result only matters for the
+// overshoot of the negative lobes.
+const char* const resampleFragmentShader = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+uniform sampler2D uTex;
+uniform int uFilter;
+uniform float uGrid;
+uniform int uLayout;        // a FrameLayout: RGBA, or luma in uTex with NV12 / I420 chroma
+uniform sampler2D uChroma;
+uniform sampler2D uChromaV;
+uniform mat4 uYuv;
+
+vec4 fetch(vec2 uv){
+    if(uLayout == 0)
+        return texture(uTex, uv);
+
+    vec2 c = uLayout == 1 ? texture(uChroma, uv).rg
+                          : vec2(texture(uChroma, uv).r, texture(uChromaV, uv).r);
+    vec3 rgb = (uYuv * vec4(texture(uTex, uv).r, c, 1.0)).rgb;
+    return vec4(clamp(rgb, 0.0, 1.0), 1.0);
+}
+
+float cubic(float x){
+    x = abs(x);
+    if(x < 1.0)
+        return (1.5 * x - 2.5) * x * x + 1.0;
+    if(x < 2.0)
+        return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+}
+
+float lanczos3(float x){
+    x = abs(x);
+    if(x < 1e-4)
+        return 1.0;
+    if(x >= 3.0)
+        return 0.0;
+    float px = 3.14159265 * x;
+    return 3.0 * sin(px) * sin(px / 3.0) / (px * px);
+}
+
+float weight(float x){
+    return uFilter == 2 ? cubic(x) : lanczos3(x);
+}
+
+vec4 convolve(vec2 p, vec2 scale){
+    float radius = uFilter == 2 ? 2.0 : 3.0;
+    vec2 c = p - 0.5;
+    vec2 r = radius * scale;
+    ivec2 i0 = ivec2(ceil(c - r));
+    ivec2 i1 = ivec2(floor(c + r));
+    ivec2 last = textureSize(uTex, 0) - 1;
+
+    vec4 sum = vec4(0.0);
+    float total = 0.0;
+    for(int y = i0.y; y <= i1.y; y++){
+        float wy = weight((float(y) - c.y) / scale.y);
+        for(int x = i0.x; x <= i1.x; x++){
+            float w = wy * weight((float(x) - c.x) / scale.x);
+            sum += w * texelFetch(uTex, clamp(ivec2(x, y), ivec2(0), last), 0);
+            total += w;
+        }
+    }
+
+    return clamp(sum / total, 0.0, 1.0);
+}
+
+void main(){
+    if(uFilter == 0){
+        FragColor = fetch(vUV);
+        return;
+    }
+
+    vec2 size = vec2(textureSize(uTex, 0));
+    vec2 p = vUV * size;
+    vec2 fw = max(fwidth(p), vec2(1e-5));
+    if(uFilter != 1){
+        FragColor = convolve(p, clamp(fw, 1.0, 2.0));
+        return;
+    }
+
+    // hard texel edges, softened over one screen pixel
+    vec2 t = floor(p) + 0.5 + clamp((fract(p) - 0.5) / fw, -0.5, 0.5);
+    vec4 color = fetch(t / size);
+
+    vec2 edge = min(fract(p), 1.0 - fract(p)) / fw;
+    float line = 1.0 - clamp(min(edge.x, edge.y), 0.0, 1.0);
+    FragColor = mix(color, vec4(0.5, 0.5, 0.5, 1.0), uGrid * line);
+}
+)";
@@ -0,0 +1,56 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include <string>
+
+// How image pixels are reconstructed on screen. Bilinear is the cheap
+// path used while the view moves; the others are the quality it refines
+// to once it is still.
+enum class ResampleFilter{
+    Bilinear,   // one hardware fetch
+    Nearest,    // square pixels with anti-aliased edges, pixel grid at high zoom
+    Bicubic,    // Catmull-Rom, 4x4 taps at 1:1
+    Lanczos     // Lanczos-3, 6x6 taps at 1:1
+};
+
+bool parseResampleFilter(const std::string& name, ResampleFilter& filter);
+const char* resampleFilterName(ResampleFilter filter);
+
+// Widest reach of any kernel in texels past the texel under the sample,
+// with up to 2:1 minification (the tile level is always chosen so that
+// no more than that is left). Tiles carry at least this much gutter.
+static constexpr int resampleReach = 6;
+
+// Magnification from which Nearest draws the grid between pixels.
+static constexpr float pixelGridZoom = 8.0f;
+
+// Fragment shader of the tile program. Reads uTex through the filter in
+// uFilter (a ResampleFilter value) and blends the pixel grid in at uGrid
+// opacity. The bicubic and Lanczos kernels are stretched by the
+// minification, so they filter instead of aliasing when zoomed out.
+// YUV stream frames (uLayout, uYuv) are converted in the bilinear and
+// nearest paths, the only ones they are drawn with.
+extern const char* const resampleFragmentShader;
+
+#endif // RESAMPLE_H
@@ -0,0 +1,305 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "stream.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// Chroma is half size, rounded up for odd sizes.
+static int chromaSize(int n){
+    return (n + 1) / 2;
+}
+
+void FrameStream::submit(const unsigned char* rgba, int w, int h){
+    Frame& f = slots[writeSlot];
+    f.w = w;
+    f.h = h;
+    f.format = FrameFormat();
+    f.pixels.assign(rgba, rgba + (size_t)w * h * 4);
+    publish();
+}
+
+void FrameStream::submitYuv(const unsigned char* const planes[3], const int strides[3], int w, int h,
+                            const FrameFormat& format){
+    if(format.layout == FrameLayout::RGBA){
+        submit(planes[0], w, h);
+        return;
+    }
+
+    Frame& f = slots[writeSlot];
+    f.w = w;
+    f.h = h;
+    f.format = format;
+
+    // Y, then UV or U and V, each packed to its own width
+    int cw = chromaSize(w), ch = chromaSize(h);
+    int count = format.layout == FrameLayout::NV12 ? 2 : 3;
+    int widths[3] = {w, format.layout == FrameLayout::NV12 ? cw * 2 : cw, cw};
+    int heights[3] = {h, ch, ch};
+    f.pixels.resize((size_t)w * h + (size_t)cw * ch * 2);
+    unsigned char* dst = f.pixels.data();
+    for(int p = 0; p < count; p++){
+        for(int y = 0; y < heights[p]; y++){
+            memcpy(dst, planes[p] + (size_t)y * strides[p], widths[p]);
+            dst += widths[p];
+        }
+    }
+    publish();
+}
+
+void FrameStream::publish(){
+    slots[writeSlot].submitted = Clock::now();
+
+    // publish our slot and take over whatever was in the middle; if the
+    // renderer never picked that one up it is gone for good
+    unsigned prev = middle.exchange(writeSlot | freshBit, std::memory_order_acq_rel);
+    if(prev & freshBit)
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+
+    writeSlot = prev & (freshBit - 1);
+    submittedCount.fetch_add(1, std::memory_order_relaxed);
+
+    if(void (*fn)() = notify.load())
+        fn();
+}
+
+const FrameStream::Frame* FrameStream::acquire(){
+    if(!(middle.load(std::memory_order_relaxed) & freshBit))
+        return nullptr;
+
+    unsigned prev = middle.exchange(readSlot, std::memory_order_acq_rel);
+    readSlot = prev & (freshBit - 1);
+    unpresented = true;
+    return &slots[readSlot];
+}
+
+void FrameStream::presented(){
+    if(!unpresented)
+        return;
+
+    unpresented = false;
+    double ms = std::chrono::duration<double, std::milli>(
+        Clock::now() - slots[readSlot].submitted).count();
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    displayedCount++;
+    if(latency.size() < latencySamples)
+        latency.push_back(ms);
+    else
+        latency[latencyPos++ % latencySamples] = ms;
+}
+
+FrameStream::Stats FrameStream::stats() const {
+    Stats s;
+    s.submitted = submittedCount.load();
+    s.dropped = droppedCount.load();
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    s.displayed = displayedCount;
+    s.latencyMs = latency;
+    return s;
+}
+
+void StreamTexture::init(GLuint program){
+    locRect = glGetUniformLocation(program, "uRect");
+    locUVRect = glGetUniformLocation(program, "uUVRect");
+    locLayout = glGetUniformLocation(program, "uLayout");
+    locYuv = glGetUniformLocation(program, "uYuv");
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uChroma"), 1);
+    glUniform1i(glGetUniformLocation(program, "uChromaV"), 2);
+}
+
+void StreamTexture::destroy(){
+    glDeleteTextures(2, tex);
+    glDeleteTextures(4, &chroma[0][0]);
+    glDeleteBuffers(1, &pbo);
+    tex[0] = tex[1] = pbo = 0;
+    chroma[0][0] = chroma[0][1] = chroma[1][0] = chroma[1][1] = 0;
+    texW[0] = texW[1] = texH[0] = texH[1] = 0;
+    texFormat[0] = texFormat[1] = FrameFormat();
+    front = 0;
+}
+
+// Storage for every mip level of a w x h texture.
+static void allocate(GLuint t, GLint internal, GLenum fmt, int w, int h){
+    glBindTexture(GL_TEXTURE_2D, t);
+    int levels = 1;
+    while(std::max(w, h) >> levels)
+        levels++;
+
+    for(int l = 0; l < levels; l++)
+        glTexImage2D(GL_TEXTURE_2D, l, internal, std::max(w >> l, 1), std::max(h >> l, 1), 0,
+                     fmt, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+}
+
+// Y'CbCr to R'G'B' as a column-major 4x4 on (Y, Cb, Cr, 1) as sampled,
+// the range expansion and the chroma offset folded in.
+static void yuvToRgb(const FrameFormat& f, float m[16]){
+    double kr = f.matrix == YuvMatrix::BT601 ? 0.299 : 0.2126;
+    double kb = f.matrix == YuvMatrix::BT601 ? 0.114 : 0.0722;
+    double kg = 1.0 - kr - kb;
+    double rv = 2.0 * (1.0 - kr), bu = 2.0 * (1.0 - kb);
+    double coef[3][3] = {{1.0, 0.0, rv}, {1.0, -bu * kb / kg, -rv * kr / kg}, {1.0, bu, 0.0}};
+
+    // limited range has black at 16, white at 235 and chroma in 16-240
+    double scale[3] = {255.0 / 219.0, 255.0 / 224.0, 255.0 / 224.0};
+    double offset[3] = {16.0 / 255.0, 128.0 / 255.0, 128.0 / 255.0};
+    if(f.fullRange){
+        scale[0] = scale[1] = scale[2] = 1.0;
+        offset[0] = 0.0;
+    }
+
+    for(int r = 0; r < 3; r++){
+        double c = 0.0;
+        for(int i = 0; i < 3; i++){
+            m[i * 4 + r] = (float)(coef[r][i] * scale[i]);
+            c -= coef[r][i] * scale[i] * offset[i];
+        }
+        m[12 + r] = (float)c;
+        m[r * 4 + 3] = 0.0f;
+    }
+    m[15] = 1.0f;
+}
+
+bool StreamTexture::upload(const FrameStream::Frame& frame){
+    if(!stage(frame))
+        return false;
+
+    flip();
+    return true;
+}
+
+bool StreamTexture::stage(const FrameStream::Frame& frame){
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if(frame.w > maxSize || frame.h > maxSize){
+        std::cerr << "Stream frame " << frame.w << "x" << frame.h
+                  << " exceeds GL_MAX_TEXTURE_SIZE " << maxSize << "\n";
+        return false;
+    }
+
+    if(!pbo){
+        glGenTextures(2, tex);
+        glGenTextures(4, &chroma[0][0]);
+        glGenBuffers(1, &pbo);
+        GLuint all[6] = {tex[0], tex[1], chroma[0][0], chroma[0][1], chroma[1][0], chroma[1][1]};
+        for(GLuint t : all){
+            glBindTexture(GL_TEXTURE_2D, t);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+    }
+
+    // the planes and the textures they go into: RGBA alone, or luma
+    // with UV as two channels or U and V as one each
+    FrameLayout layout = frame.format.layout;
+    int cw = chromaSize(frame.w), ch = chromaSize(frame.h);
+    int back = front ^ 1;
+    struct Plane{ GLuint tex; GLint internal; GLenum fmt; int w, h, bpp; } planes[3];
+    int count = 1;
+    if(layout == FrameLayout::RGBA)
+        planes[0] = {tex[back], GL_RGBA8, GL_RGBA, frame.w, frame.h, 4};
+    else {
+        planes[0] = {tex[back], GL_R8, GL_RED, frame.w, frame.h, 1};
+        if(layout == FrameLayout::NV12){
+            planes[1] = {chroma[back][0], GL_RG8, GL_RG, cw, ch, 2};
+            count = 2;
+        } else {
+            planes[1] = {chroma[back][0], GL_R8, GL_RED, cw, ch, 1};
+            planes[2] = {chroma[back][1], GL_R8, GL_RED, cw, ch, 1};
+            count = 3;
+        }
+    }
+
+    if(frame.w != texW[back] || frame.h != texH[back] || layout != texFormat[back].layout){
+        for(int p = 0; p < count; p++)
+            allocate(planes[p].tex, planes[p].internal, planes[p].fmt, planes[p].w, planes[p].h);
+        texW[back] = frame.w;
+        texH[back] = frame.h;
+    }
+    texFormat[back] = frame.format;
+
+    // orphan the buffer: the driver hands out fresh storage while the
+    // previous frame's copy may still be in flight
+    size_t size = frame.pixels.size();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if(dst){
+        memcpy(dst, frame.pixels.data(), size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        size_t offset = 0;
+        for(int p = 0; p < count; p++){
+            glBindTexture(GL_TEXTURE_2D, planes[p].tex);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, planes[p].w, planes[p].h, planes[p].fmt,
+                            GL_UNSIGNED_BYTE, (void*)offset);
+            offset += (size_t)planes[p].w * planes[p].h * planes[p].bpp;
+        }
+        uploaded += size;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    for(int p = 0; p < count; p++){
+        glBindTexture(GL_TEXTURE_2D, planes[p].tex);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    return dst != nullptr;
+}
+
+void StreamTexture::draw(GLuint quadVAO) const {
+    if(!texW[front])
+        return;
+
+    // YUV rows come top first, the texture coordinates turn them over
+    const FrameFormat& f = texFormat[front];
+    bool yuv = f.layout != FrameLayout::RGBA;
+    glUniform4f(locRect, 0.0f, 0.0f, (float)texW[front], (float)texH[front]);
+    if(yuv)
+        glUniform4f(locUVRect, 0.0f, 1.0f, 1.0f, -1.0f);
+    else
+        glUniform4f(locUVRect, 0.0f, 0.0f, 1.0f, 1.0f);
+
+    if(yuv){
+        float m[16];
+        yuvToRgb(f, m);
+        glUniformMatrix4fv(locYuv, 1, GL_FALSE, m);
+        glUniform1i(locLayout, (int)f.layout);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, chroma[front][1]);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, chroma[front][0]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tex[front]);
+    glBindVertexArray(quadVAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+    // tiles share the program and are always RGBA
+    if(yuv)
+        glUniform1i(locLayout, (int)FrameLayout::RGBA);
+}
@@ -0,0 +1,156 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// How a frame's pixels are laid out. RGBA8 rows run bottom to top. The
+// YUV layouts are 8-bit 4:2:0 as cameras and video decoders deliver it,
+// rows top to bottom: a full-size luma plane, then chroma at half width
+// and height, interleaved (NV12) or as a U and a V plane (I420).
+enum class FrameLayout{
+    RGBA,
+    NV12,
+    I420
+};
+
+enum class YuvMatrix{
+    BT601,
+    BT709
+};
+
+struct FrameFormat{
+    FrameLayout layout = FrameLayout::RGBA;
+    YuvMatrix matrix = YuvMatrix::BT709;    // YUV layouts only
+    bool fullRange = false;                 // 0-255 rather than 16-235 / 16-240
+};
+
+// Live frames pushed by one producer thread while the window is open. A
+// lock-free triple buffer: the producer fills its own slot and swaps it
+// with the shared middle slot, the render thread swaps the middle slot
+// with the one it reads from. Neither side ever waits on the other; a
+// frame the renderer has not picked up before the next one arrives is
+// dropped.
+class FrameStream{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Frame{
+        std::vector<unsigned char> pixels;  // the planes one after another, no padding
+        int w = 0, h = 0;
+        FrameFormat format;
+        Clock::time_point submitted;
+    };
+
+    struct Stats{
+        unsigned long submitted = 0, displayed = 0, dropped = 0;
+        std::vector<double> latencyMs;      // submit -> presented, recent frames
+    };
+
+    // Producer side; copies the frame and returns at once.
+    void submit(const unsigned char* rgba, int w, int h);
+    // planes[i] has strides[i] bytes per row: Y and UV for NV12, Y, U
+    // and V for I420. Only the planes are copied, 1.5 bytes a pixel.
+    void submitYuv(const unsigned char* const planes[3], const int strides[3], int w, int h,
+                   const FrameFormat& format);
+    // Called from the producer thread after each submit. A plain function
+    // pointer so it can be swapped while the producer runs.
+    void setNotify(void (*fn)()) { notify.store(fn); }
+
+    // Render side: the newest frame not seen yet, or nullptr.
+    const Frame* acquire();
+    // Marks the last acquired frame as on screen.
+    void presented();
+    bool active() const { return submittedCount.load(std::memory_order_relaxed) > 0; }
+
+    // Safe from any thread.
+    Stats stats() const;
+
+private:
+    // hands the filled write slot over to the render side
+    void publish();
+
+    static constexpr unsigned freshBit = 4;
+    static constexpr size_t latencySamples = 8192;
+
+    Frame slots[3];
+    std::atomic<unsigned> middle{1};
+    unsigned writeSlot = 0;                 // producer only
+    unsigned readSlot = 2;                  // render thread only
+    bool unpresented = false;               // render thread only
+    std::atomic<unsigned long> submittedCount{0}, droppedCount{0};
+    std::atomic<void (*)()> notify{nullptr};
+    // the producer never touches these
+    mutable std::mutex statsMutex;
+    unsigned long displayedCount = 0;
+    std::vector<double> latency;
+    size_t latencyPos = 0;
+};
+
+// GPU side of a FrameStream or an animation: a front texture on screen
+// and a back one the next frame goes into, filled through an orphaned
+// pixel buffer so the upload never stalls on a frame still being read,
+// with hardware mipmaps for zooming out. Animations fill the back
+// texture ahead of time and flip when the frame is due. YUV frames go
+// up as they are, luma and chroma in textures of their own, and the
+// tile program converts them.
+class StreamTexture{
+public:
+    // Caches the uniform locations of the tile program and binds its
+    // chroma samplers to texture units 1 and 2.
+    void init(GLuint program);
+    void destroy();
+
+    // Fills the back texture. False if the frame is larger than the GL
+    // allows.
+    bool stage(const FrameStream::Frame& frame);
+    // Puts the back texture on screen.
+    void flip() { front ^= 1; }
+    // Both at once, for live frames.
+    bool upload(const FrameStream::Frame& frame);
+
+    int width() const { return texW[front]; }
+    int height() const { return texH[front]; }
+
+    // Draws the frame at the origin of the current image space; the tile
+    // program must be bound with uProj / uPan / uZoom already set.
+    void draw(GLuint quadVAO) const;
+
+    size_t bytesUploaded() const { return uploaded; }
+
+private:
+    GLuint tex[2] = {0, 0}, pbo = 0;        // RGBA, or luma
+    GLuint chroma[2][2] = {{0, 0}, {0, 0}}; // UV, or U and V
+    GLint locRect = -1, locUVRect = -1, locLayout = -1, locYuv = -1;
+    int texW[2] = {0, 0}, texH[2] = {0, 0};
+    FrameFormat texFormat[2];
+    int front = 0;
+    size_t uploaded = 0;
+};
+
+#endif // STREAM_H
@@ -0,0 +1,409 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "texcompress.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+bool parseTextureCompression(const std::string& name, TextureCompression& mode){
+    if(name == "none")
+        mode = TextureCompression::None;
+    else if(name == "bc1")
+        mode = TextureCompression::BC1;
+    else if(name == "bc7")
+        mode = TextureCompression::BC7;
+    else if(name == "auto")
+        mode = TextureCompression::Auto;
+    else
+        return false;
+
+    return true;
+}
+
+const char* textureCompressionName(TextureCompression mode){
+    switch(mode){
+        case TextureCompression::BC1: return "BC1";
+        case TextureCompression::BC7: return "BC7";
+        case TextureCompression::Auto: return "auto";
+        default: return "none";
+    }
+}
+
+int blockBytes(TextureCompression mode){
+    switch(mode){
+        case TextureCompression::BC1: return 8;
+        case TextureCompression::BC7: return 16;
+        default: return 0;
+    }
+}
+
+// Both encoders fit a line through the block's colours (principal axis
+// by power iteration), take the extreme projections as endpoints, pick
+// the nearest palette entry per pixel, then refit the endpoints to those
+// indices by least squares once and keep whichever result is closer.
+
+static void fitLine(const unsigned char* px, int dims, float lo[4], float hi[4]){
+    float mean[4] = {};
+    for(int i = 0; i < 16; i++)
+        for(int c = 0; c < dims; c++)
+            mean[c] += px[i * 4 + c];
+    for(int c = 0; c < dims; c++)
+        mean[c] /= 16.0f;
+
+    float cov[4][4] = {};
+    for(int i = 0; i < 16; i++){
+        float d[4];
+        for(int c = 0; c < dims; c++)
+            d[c] = px[i * 4 + c] - mean[c];
+        for(int a = 0; a < dims; a++)
+            for(int b = 0; b < dims; b++)
+                cov[a][b] += d[a] * d[b];
+    }
+
+    float axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    for(int it = 0; it < 8; it++){
+        float v[4] = {}, m = 0.0f;
+        for(int a = 0; a < dims; a++){
+            for(int b = 0; b < dims; b++)
+                v[a] += cov[a][b] * axis[b];
+            m = std::max(m, std::fabs(v[a]));
+        }
+
+        if(m < 1e-6f)
+            break;
+        for(int a = 0; a < dims; a++)
+            axis[a] = v[a] / m;
+    }
+
+    float len = 0.0f;
+    for(int c = 0; c < dims; c++)
+        len += axis[c] * axis[c];
+    len = std::sqrt(len);
+
+    float tmin = 0.0f, tmax = 0.0f;
+    if(len > 1e-6f){
+        for(int c = 0; c < dims; c++)
+            axis[c] /= len;
+
+        tmin = 1e9f;
+        tmax = -1e9f;
+        for(int i = 0; i < 16; i++){
+            float t = 0.0f;
+            for(int c = 0; c < dims; c++)
+                t += (px[i * 4 + c] - mean[c]) * axis[c];
+            tmin = std::min(tmin, t);
+            tmax = std::max(tmax, t);
+        }
+    }
+
+    for(int c = 0; c < dims; c++){
+        lo[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tmin));
+        hi[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tmax));
+    }
+}
+
+// Least squares endpoints for pixels interpolated at the given weights.
+static void refitLine(const unsigned char* px, int dims, const float* w, float lo[4], float hi[4]){
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for(int i = 0; i < 16; i++){
+        float b = w[i], a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for(int c = 0; c < dims; c++){
+            ax[c] += a * px[i * 4 + c];
+            bx[c] += b * px[i * 4 + c];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if(std::fabs(det) < 1e-6f)
+        return;
+
+    for(int c = 0; c < dims; c++){
+        lo[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) / det));
+        hi[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) / det));
+    }
+}
+
+// Index of the closest palette entry for every pixel; returns the total
+// squared error.
+static int pickIndices(const unsigned char* px, int dims, const int palette[][4], int entries,
+                       unsigned char* idx){
+    int total = 0;
+    for(int i = 0; i < 16; i++){
+        int best = 0, bestErr = INT32_MAX;
+        for(int e = 0; e < entries; e++){
+            int err = 0;
+            for(int c = 0; c < dims; c++){
+                int d = px[i * 4 + c] - palette[e][c];
+                err += d * d;
+            }
+
+            if(err < bestErr){
+                bestErr = err;
+                best = e;
+            }
+        }
+
+        idx[i] = (unsigned char)best;
+        total += bestErr;
+    }
+
+    return total;
+}
+
+// BC1
+
+static inline int roundPositive(float v){
+    return (int)(v + 0.5f);
+}
+
+static uint16_t pack565(const float c[4]){
+    int r = roundPositive(c[0] * 31.0f / 255.0f);
+    int g = roundPositive(c[1] * 63.0f / 255.0f);
+    int b = roundPositive(c[2] * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpack565(uint16_t v, int out[4]){
+    int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+    out[3] = 255;
+}
+
+struct BC1Result{
+    uint16_t c0, c1;
+    unsigned char idx[16];
+    int err;
+};
+
+static BC1Result tryBC1(const unsigned char* px, const float lo[4], const float hi[4]){
+    BC1Result r;
+    r.c0 = pack565(hi);
+    r.c1 = pack565(lo);
+    if(r.c0 < r.c1)
+        std::swap(r.c0, r.c1);
+
+    int palette[4][4];
+    unpack565(r.c0, palette[0]);
+    unpack565(r.c1, palette[1]);
+    for(int c = 0; c < 3; c++){
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    // equal endpoints select the three colour mode, where only index 0
+    // is safe to use
+    r.err = pickIndices(px, 3, palette, r.c0 == r.c1 ? 1 : 4, r.idx);
+    return r;
+}
+
+void encodeBC1Block(const unsigned char* px, unsigned char* out){
+    static const float weightOf[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+    float lo[4], hi[4];
+    fitLine(px, 3, lo, hi);
+
+    // pull the endpoints in a little, the extremes are rarely hit exactly
+    for(int c = 0; c < 3; c++){
+        float inset = (hi[c] - lo[c]) / 16.0f;
+        lo[c] += inset;
+        hi[c] -= inset;
+    }
+
+    BC1Result best = tryBC1(px, lo, hi);
+    if(best.c0 != best.c1){
+        // the palette runs from c0 (weight 0) to c1 (weight 1)
+        float w[16];
+        for(int i = 0; i < 16; i++)
+            w[i] = weightOf[best.idx[i]];
+
+        float a[4], b[4];
+        refitLine(px, 3, w, a, b);
+        BC1Result refit = tryBC1(px, b, a);
+        if(refit.err < best.err)
+            best = refit;
+    }
+
+    uint32_t bits = 0;
+    for(int i = 0; i < 16; i++)
+        bits |= (uint32_t)best.idx[i] << (2 * i);
+
+    out[0] = best.c0 & 0xff;
+    out[1] = best.c0 >> 8;
+    out[2] = best.c1 & 0xff;
+    out[3] = best.c1 >> 8;
+    for(int i = 0; i < 4; i++)
+        out[4 + i] = (bits >> (8 * i)) & 0xff;
+}
+
+// BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a shared low bit
+// per endpoint, 4 bit indices.
+
+static const int bc7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+static void quantizeBC7(const float e[4], int q[4], int& p){
+    int bestErr = INT32_MAX;
+    for(int pb = 0; pb < 2; pb++){
+        int qq[4], err = 0;
+        for(int c = 0; c < 4; c++){
+            qq[c] = std::min(127, roundPositive(std::max(0.0f, e[c] - pb) / 2.0f));
+            int d = qq[c] * 2 + pb - roundPositive(e[c]);
+            err += d * d;
+        }
+
+        if(err < bestErr){
+            bestErr = err;
+            p = pb;
+            std::copy(qq, qq + 4, q);
+        }
+    }
+}
+
+struct BC7Result{
+    int q0[4], q1[4], p0, p1;
+    unsigned char idx[16];
+    int err;
+};
+
+static BC7Result tryBC7(const unsigned char* px, const float lo[4], const float hi[4]){
+    BC7Result r;
+    quantizeBC7(lo, r.q0, r.p0);
+    quantizeBC7(hi, r.q1, r.p1);
+
+    int palette[16][4];
+    for(int e = 0; e < 16; e++)
+        for(int c = 0; c < 4; c++){
+            int a = r.q0[c] * 2 + r.p0, b = r.q1[c] * 2 + r.p1;
+            palette[e][c] = ((64 - bc7Weights[e]) * a + bc7Weights[e] * b + 32) >> 6;
+        }
+
+    // the palette is evenly spread along a line, so project each pixel
+    // onto it and only compare the entries around the projection
+    int d[4], dd = 0;
+    for(int c = 0; c < 4; c++){
+        d[c] = palette[15][c] - palette[0][c];
+        dd += d[c] * d[c];
+    }
+
+    if(dd == 0){
+        r.err = pickIndices(px, 4, palette, 1, r.idx);
+        return r;
+    }
+
+    r.err = 0;
+    for(int i = 0; i < 16; i++){
+        int dot = 0;
+        for(int c = 0; c < 4; c++)
+            dot += (px[i * 4 + c] - palette[0][c]) * d[c];
+
+        int guess = std::min(15, std::max(0, roundPositive(std::max(0.0f, dot * 15.0f / dd))));
+        int best = guess, bestErr = INT32_MAX;
+        for(int e = std::max(0, guess - 1); e <= std::min(15, guess + 1); e++){
+            int err = 0;
+            for(int c = 0; c < 4; c++){
+                int diff = px[i * 4 + c] - palette[e][c];
+                err += diff * diff;
+            }
+
+            if(err < bestErr){
+                bestErr = err;
+                best = e;
+            }
+        }
+
+        r.idx[i] = (unsigned char)best;
+        r.err += bestErr;
+    }
+
+    return r;
+}
+
+struct BitWriter{
+    unsigned char* out;
+    int pos = 0;
+
+    void put(unsigned v, int bits){
+        for(int i = 0; i < bits; i++, pos++)
+            if((v >> i) & 1)
+                out[pos >> 3] |= (unsigned char)(1 << (pos & 7));
+    }
+};
+
+void encodeBC7Block(const unsigned char* px, unsigned char* out){
+    float lo[4], hi[4];
+    fitLine(px, 4, lo, hi);
+
+    BC7Result best = tryBC7(px, lo, hi);
+    float w[16];
+    for(int i = 0; i < 16; i++)
+        w[i] = bc7Weights[best.idx[i]] / 64.0f;
+
+    refitLine(px, 4, w, lo, hi);
+    BC7Result refit = tryBC7(px, lo, hi);
+    if(refit.err < best.err)
+        best = refit;
+
+    // the first index is stored without its top bit, which must be zero
+    if(best.idx[0] & 8){
+        std::swap(best.q0, best.q1);
+        std::swap(best.p0, best.p1);
+        for(int i = 0; i < 16; i++)
+            best.idx[i] = 15 - best.idx[i];
+    }
+
+    memset(out, 0, 16);
+    BitWriter bw{out};
+    bw.put(1 << 6, 7);
+    for(int c = 0; c < 4; c++){
+        bw.put(best.q0[c], 7);
+        bw.put(best.q1[c], 7);
+    }
+    bw.put(best.p0, 1);
+    bw.put(best.p1, 1);
+    bw.put(best.idx[0], 3);
+    for(int i = 1; i < 16; i++)
+        bw.put(best.idx[i], 4);
+}
+
+void compressBlocks(const unsigned char* rgba, int w, int h, size_t stride,
+                    TextureCompression mode, unsigned char* out){
+    int size = blockBytes(mode);
+    unsigned char block[64];
+    for(int by = 0; by < h; by += 4){
+        for(int bx = 0; bx < w; bx += 4){
+            for(int r = 0; r < 4; r++)
+                memcpy(block + r * 16, rgba + (by + r) * stride + bx * 4, 16);
+
+            if(mode == TextureCompression::BC1)
+                encodeBC1Block(block, out);
+            else
+                encodeBC7Block(block, out);
+            out += size;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef TEXCOMPRESS_H
+#define TEXCOMPRESS_H
+
+#include <cstddef>
+#include <string>
+
+// GPU block compression for image tiles.
+enum class TextureCompression{
+    None,       // RGBA8
+    BC1,        // 4 bits per pixel, opaque
+    BC7,        // 8 bits per pixel, mode 6 (RGBA)
+    Auto        // BC1 for opaque images, BC7 otherwise
+};
+
+bool parseTextureCompression(const std::string& name, TextureCompression& mode);
+const char* textureCompressionName(TextureCompression mode);
+
+// Bytes per 4x4 block, 0 for None / Auto.
+int blockBytes(TextureCompression mode);
+
+// Both take a 4x4 block of RGBA pixels, rows of 16 bytes.
+void encodeBC1Block(const unsigned char* rgba, unsigned char* out);
+void encodeBC7Block(const unsigned char* rgba, unsigned char* out);
+
+// Encodes w x h RGBA pixels (both multiples of 4, rows stride bytes
+// apart) into blocks stored left to right, top to bottom.
+void compressBlocks(const unsigned char* rgba, int w, int h, size_t stride,
+                    TextureCompression mode, unsigned char* out);
+
+#endif // TEXCOMPRESS_H
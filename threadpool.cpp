@@ -0,0 +1,124 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "threadpool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads){
+    if(threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for(unsigned i = 0; i < threads; i++)
+        workers.emplace_back([this](){ run(); });
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+
+    cv.notify_all();
+    for(auto &t : workers)
+        t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(task));
+    }
+
+    cv.notify_one();
+}
+
+void ThreadPool::clear(){
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.clear();
+}
+
+void ThreadPool::run(){
+    for(;;){
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this](){ return stopping || !queue.empty(); });
+            if(stopping)
+                return;
+
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        task();
+    }
+}
+
+void parallelForStealing(size_t count, unsigned threads,
+                         const std::function<void(size_t, unsigned)>& fn){
+    if(threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned)std::min<size_t>(threads, std::max<size_t>(count, 1));
+
+    struct Share{
+        std::mutex mutex;
+        size_t begin = 0, end = 0;
+    };
+
+    std::vector<Share> shares(threads);
+    for(unsigned t = 0; t < threads; t++){
+        shares[t].begin = count * t / threads;
+        shares[t].end = count * (t + 1) / threads;
+    }
+
+    auto work = [&](unsigned self){
+        for(;;){
+            size_t i = count;
+            {
+                Share& own = shares[self];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if(own.begin < own.end)
+                    i = own.begin++;
+            }
+
+            // own share done: take the last task of the next busy thread
+            for(unsigned k = 1; i == count && k < threads; k++){
+                Share& victim = shares[(self + k) % threads];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if(victim.begin < victim.end)
+                    i = --victim.end;
+            }
+
+            if(i == count)
+                return;
+
+            fn(i, self);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for(unsigned t = 1; t < threads; t++)
+        pool.emplace_back(work, t);
+    work(0);
+    for(auto &t : pool)
+        t.join();
+}
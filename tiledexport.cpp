@@ -0,0 +1,209 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "tiledexport.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// Wide and short tiles: a strip holds few of them, and a strip is what
+// has to be in flight before its rows can be written.
+constexpr int maxTileW = 4096;
+constexpr int maxTileH = 512;
+constexpr int maxAttempts = 2000;
+
+struct Output{
+    FILE* file = nullptr;
+    bool ppm = false;           // top row first; TGA is bottom row first
+    std::vector<unsigned char> row;
+
+    bool open(const std::string& path, int w, int h){
+        ppm = path.size() > 4 && path.compare(path.size() - 4, 4, ".ppm") == 0;
+        file = fopen(path.c_str(), "wb");
+        if(!file)
+            return false;
+
+        row.resize((size_t)w * 3);
+        if(ppm)
+            return fprintf(file, "P6\n%d %d\n255\n", w, h) > 0;
+
+        // uncompressed true colour, origin at the bottom left
+        unsigned char header[18] = {};
+        header[2] = 2;
+        header[12] = (unsigned char)(w & 255);
+        header[13] = (unsigned char)(w >> 8);
+        header[14] = (unsigned char)(h & 255);
+        header[15] = (unsigned char)(h >> 8);
+        header[16] = 24;
+        return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    }
+};
+
+// One strip of tiles read back into a set of pixel buffers.
+struct Strip{
+    int y = 0, h = 0;
+    std::vector<GLuint> pbos;
+};
+
+bool writeStrip(Output& out, const Strip& s, int width, int tileW){
+    size_t cols = s.pbos.size();
+    std::vector<const unsigned char*> src(cols);
+    for(size_t c = 0; c < cols; c++){
+        int w = std::min(tileW, width - (int)c * tileW);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbos[c]);
+        src[c] = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                                        (GLsizeiptr)w * s.h * 4, GL_MAP_READ_BIT);
+    }
+
+    bool ok = std::find(src.begin(), src.end(), nullptr) == src.end();
+    for(int i = 0; ok && i < s.h; i++){
+        int r = out.ppm ? s.h - 1 - i : i;
+        unsigned char* d = out.row.data();
+        for(size_t c = 0; c < cols; c++){
+            int w = std::min(tileW, width - (int)c * tileW);
+            const unsigned char* p = src[c] + (size_t)r * w * 4;
+            for(int x = 0; x < w; x++, p += 4, d += 3){
+                d[0] = out.ppm ? p[0] : p[2];
+                d[1] = p[1];
+                d[2] = out.ppm ? p[2] : p[0];
+            }
+        }
+
+        ok = fwrite(out.row.data(), 1, out.row.size(), out.file) == out.row.size();
+    }
+
+    for(size_t c = 0; c < cols; c++){
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbos[c]);
+        if(src[c])
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    return ok;
+}
+
+} // namespace
+
+bool exportTiled(const std::string& path, int width, int height, const ExportTileFn& render,
+                 std::string& err){
+    if(width <= 0 || height <= 0 || width > 65535 || height > 65535){
+        err = "Export size out of range: " + std::to_string(width) + "x" + std::to_string(height);
+        return false;
+    }
+
+    GLint maxRb = 0, maxVp[2] = {};
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRb);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxVp);
+    int tileW = std::min({width, maxTileW, (int)maxRb, (int)maxVp[0]});
+    int tileH = std::min({height, maxTileH, (int)maxRb, (int)maxVp[1]});
+    int cols = (width + tileW - 1) / tileW;
+    int rows = (height + tileH - 1) / tileH;
+
+    Output out;
+    if(!out.open(path, width, height)){
+        err = "Cannot write " + path;
+        if(out.file)
+            fclose(out.file);
+        return false;
+    }
+
+    GLint oldDraw = 0, oldRead = 0, oldViewport[4] = {};
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &oldDraw);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &oldRead);
+    glGetIntegerv(GL_VIEWPORT, oldViewport);
+
+    GLuint fbo = 0, rb = 0;
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &rb);
+    glBindRenderbuffer(GL_RENDERBUFFER, rb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, tileW, tileH);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rb);
+    bool ok = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if(!ok)
+        err = "Export framebuffer incomplete";
+
+    // two strips: one being read back while the other is written out
+    Strip strips[2];
+    for(Strip &s : strips){
+        s.pbos.resize(cols);
+        glGenBuffers(cols, s.pbos.data());
+        for(GLuint pbo : s.pbos){
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)tileW * tileH * 4, nullptr, GL_STREAM_READ);
+        }
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    Strip* previous = nullptr;
+    for(int i = 0; ok && i < rows; i++){
+        // rows go out in file order: top strip first for PPM
+        int strip = out.ppm ? rows - 1 - i : i;
+        Strip& s = strips[i & 1];
+        s.y = strip * tileH;
+        s.h = std::min(tileH, height - s.y);
+
+        for(int c = 0; c < cols; c++){
+            int x = c * tileW;
+            int w = std::min(tileW, width - x);
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glViewport(0, 0, w, s.h);
+            int attempt = 0;
+            while(!render(x, s.y, w, s.h) && ++attempt < maxAttempts){}
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbos[c]);
+            glReadPixels(0, 0, w, s.h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+
+        // the strip before this one has had a whole strip of rendering
+        // to finish its transfer
+        if(previous && !writeStrip(out, *previous, width, tileW)){
+            err = "Failed writing " + path;
+            ok = false;
+        }
+        previous = &s;
+    }
+
+    if(ok && previous && !writeStrip(out, *previous, width, tileW)){
+        err = "Failed writing " + path;
+        ok = false;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    for(Strip &s : strips)
+        glDeleteBuffers(cols, s.pbos.data());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, oldDraw);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, oldRead);
+    glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
+    glDeleteRenderbuffers(1, &rb);
+    glDeleteFramebuffers(1, &fbo);
+
+    if(fclose(out.file) != 0 && ok){
+        err = "Failed writing " + path;
+        ok = false;
+    }
+
+    return ok;
+}
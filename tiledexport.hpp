@@ -0,0 +1,45 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef TILEDEXPORT_H
+#define TILEDEXPORT_H
+
+#include <functional>
+#include <string>
+
+// Draws the output pixels [x, x + w) x [y, y + h) (origin at the bottom
+// left) into the bound framebuffer, whose viewport is already w x h.
+// Returns false while content is still streaming in; the same tile is
+// then drawn again.
+typedef std::function<bool(int x, int y, int w, int h)> ExportTileFn;
+
+// Renders a width x height image far larger than any framebuffer the
+// driver allows, one offscreen tile at a time, and writes it to path as
+// 24-bit TGA, or binary PPM if the name ends in ".ppm". Tiles are read
+// back through pixel buffer objects while the next strip renders and
+// are streamed to the file row by row, so memory stays at two strips of
+// tiles whatever the output size. Needs a GL context current; restores
+// the framebuffer and viewport bindings. Returns false and fills err on
+// failure.
+bool exportTiled(const std::string& path, int width, int height, const ExportTileFn& render,
+                 std::string& err);
+
+#endif // TILEDEXPORT_H
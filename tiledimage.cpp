@@ -0,0 +1,615 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "tiledimage.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+void TiledImage::init(GLuint program){
+    locRect = glGetUniformLocation(program, "uRect");
+    locUVRect = glGetUniformLocation(program, "uUVRect");
+    glGenBuffers(pboCount, pbos);
+
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0; i < count; i++){
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if(!strcmp(ext, "GL_EXT_texture_compression_s3tc"))
+            hasBC1 = true;
+        else if(!strcmp(ext, "GL_ARB_texture_compression_bptc"))
+            hasBC7 = true;
+    }
+
+    // BPTC is core since 4.2
+    if(GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 2))
+        hasBC7 = true;
+}
+
+void textureFormat(int channels, GLint& internal, GLenum& format){
+    switch(channels){
+        case 1: internal = GL_R8; format = GL_RED; break;
+        case 2: internal = GL_RG8; format = GL_RG; break;
+        case 3: internal = GL_RGB8; format = GL_RGB; break;
+        default: internal = GL_RGBA8; format = GL_RGBA;
+    }
+}
+
+void textureSwizzle(int channels, bool bgr){
+    static const GLint swizzles[4][4] = {
+        {GL_RED, GL_RED, GL_RED, GL_ONE},
+        {GL_RED, GL_RED, GL_RED, GL_GREEN},
+        {GL_RED, GL_GREEN, GL_BLUE, GL_ONE},
+        {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA}
+    };
+    GLint s[4];
+    memcpy(s, swizzles[std::min(std::max(channels, 1), 4) - 1], sizeof(s));
+    if(bgr && channels >= 3)
+        std::swap(s[0], s[2]);
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, s);
+}
+
+void TiledImage::setImage(std::shared_ptr<Image> img){
+    TextureCompression fmt = TextureCompression::None;
+    if(img && requested != TextureCompression::None){
+        fmt = requested;
+        if(fmt == TextureCompression::Auto)
+            fmt = img->opaque ? TextureCompression::BC1 : TextureCompression::BC7;
+
+        if((fmt == TextureCompression::BC1 && !hasBC1) || (fmt == TextureCompression::BC7 && !hasBC7)){
+            std::cerr << textureCompressionName(fmt) << " textures are not supported here, "
+                      << "tiles stay uncompressed\n";
+            requested = fmt = TextureCompression::None;
+        }
+    }
+
+    // spare textures only take tiles of their own format
+    int channels = img && fmt == TextureCompression::None ? img->channels : 4;
+    bool bgr = img && fmt == TextureCompression::None && img->bgr;
+    if(fmt != format || channels != texChannels || bgr != texBgr)
+        release();
+    format = fmt;
+    texChannels = channels;
+    texBgr = bgr;
+
+    // keep the textures around for the next image instead of freeing them,
+    // switching images then costs uploads only
+    for(auto &it : tiles)
+        spare.push_back(it.second.tex);
+
+    tiles.clear();
+    lru.clear();
+
+    // queued encodes belong to the old image; running ones finish into
+    // the old image's block store and are dropped with it
+    if(encoder)
+        encoder->clear();
+    submitted.clear();
+    encoded.reset();
+
+    image = std::move(img);
+    if(!image)
+        return;
+
+    if(format == TextureCompression::None){
+        tileBytes = (size_t)texSize * texSize * image->channels;
+        return;
+    }
+
+    tileBytes = (size_t)(blockTexSize / 4) * (blockTexSize / 4) * blockBytes(format);
+    encoded = std::make_shared<EncodedTiles>();
+    if(!encoder)
+        encoder.reset(new ThreadPool);
+
+    // everything else falls back on the top level, so it goes first
+    requestEncode((int)image->levels.size() - 1, 0, 0);
+}
+
+void TiledImage::setBudget(size_t b){
+    budget = b;
+}
+
+void TiledImage::setCompression(TextureCompression mode){
+    requested = mode;
+}
+
+size_t TiledImage::uncompressedBytes() const {
+    return tileBytes ? bytes / tileBytes * ((size_t)texSize * texSize * 4) : 0;
+}
+
+TiledImage::Stats TiledImage::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return counters;
+}
+
+GLenum TiledImage::glFormat() const {
+    switch(format){
+        case TextureCompression::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TextureCompression::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        default: return GL_RGBA8;
+    }
+}
+
+void TiledImage::release(){
+    for(auto &it : tiles)
+        glDeleteTextures(1, &it.second.tex);
+
+    if(!spare.empty())
+        glDeleteTextures((GLsizei)spare.size(), spare.data());
+
+    tiles.clear();
+    lru.clear();
+    spare.clear();
+    bytes = 0;
+}
+
+void TiledImage::destroy(){
+    release();
+    glDeleteBuffers(pboCount, pbos);
+    encoder.reset();
+    encoded.reset();
+    submitted.clear();
+    format = TextureCompression::None;
+    image.reset();
+    counters = Stats();
+}
+
+void TiledImage::beginFrame(){
+    frame++;
+    uploads = 0;
+    missing = false;
+    waiting = false;
+    if(encoded)
+        encoded->fresh = false;
+}
+
+uint64_t TiledImage::tileKey(int level, int tx, int ty){
+    return ((uint64_t)level << 48) | ((uint64_t)(uint32_t)ty << 24) | (uint64_t)(uint32_t)tx;
+}
+
+int TiledImage::levelForZoom(float zoom) const {
+    if(!image)
+        return 0;
+
+    int top = (int)image->levels.size() - 1;
+    int level = (int)floor(log2(1.0f / zoom));
+    return std::max(0, std::min(level, top));
+}
+
+TiledImage::Tile* TiledImage::find(uint64_t key){
+    auto it = tiles.find(key);
+    if(it == tiles.end())
+        return nullptr;
+
+    Tile &t = it->second;
+    t.frame = frame;
+    lru.splice(lru.begin(), lru, t.lru);
+    return &t;
+}
+
+GLuint TiledImage::acquireTexture(){
+    if(!spare.empty()){
+        GLuint tex = spare.back();
+        spare.pop_back();
+        return tex;
+    }
+
+    // over budget: take over the least recently used tile that is not
+    // needed this frame (the pinned top level never qualifies)
+    if(bytes + tileBytes > budget){
+        int top = (int)image->levels.size() - 1;
+        for(auto it = lru.rbegin(); it != lru.rend(); ++it){
+            uint64_t key = *it;
+            auto t = tiles.find(key);
+            if(t->second.frame == frame || (int)(key >> 48) == top)
+                continue;
+
+            GLuint tex = t->second.tex;
+            lru.erase(t->second.lru);
+            tiles.erase(t);
+            return tex;
+        }
+    }
+
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    if(format == TextureCompression::None){
+        GLint internal;
+        GLenum fmt;
+        textureFormat(texChannels, internal, fmt);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal, texSize, texSize, 0, fmt, GL_UNSIGNED_BYTE, nullptr);
+        textureSwizzle(texChannels, texBgr);
+    } else
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, glFormat(), blockTexSize, blockTexSize, 0,
+                               (GLsizei)tileBytes, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    bytes += tileBytes;
+    return tex;
+}
+
+void TiledImage::fillTile(unsigned char* dst, const ImageLevel& lv, int x0, int y0, int w, int h,
+                          int n){
+    // copies w x h pixels from (x0, y0), repeating the edge of the level
+    // for whatever lies outside it. Tiles read a gutter of their
+    // neighbours' pixels this way, so neither linear filtering nor the
+    // wider resampling kernels show seams.
+    int left = std::min(std::max(-x0, 0), w);
+    int right = std::min(std::max(x0 + w - lv.w, 0), w - left);
+    int mid = w - left - right;
+
+    for(int r = 0; r < h; r++){
+        int sy = std::max(0, std::min(y0 + r, lv.h - 1));
+        const unsigned char* src = lv.pixels + sy * lv.stride;
+        unsigned char* out = dst + (size_t)r * w * n;
+        for(int i = 0; i < left; i++)
+            memcpy(out + i * n, src, n);
+        memcpy(out + (size_t)left * n, src + (size_t)(x0 + left) * n, (size_t)mid * n);
+        for(int i = 0; i < right; i++)
+            memcpy(out + (size_t)(left + mid + i) * n, src + (size_t)(lv.w - 1) * n, n);
+    }
+}
+
+void TiledImage::requestEncode(int level, int tx, int ty){
+    uint64_t key = tileKey(level, tx, ty);
+    if(!submitted.insert(key).second)
+        return;
+
+    // the level by value: a region update may point the image's levels
+    // at new storage while this runs, the old pixels live on with img
+    std::shared_ptr<Image> img = image;
+    ImageLevel lv = image->levels[level];
+    std::shared_ptr<EncodedTiles> out = encoded;
+    TextureCompression fmt = format;
+    int g = gutter();
+    std::function<void()> done = notify;
+    unsigned gen;
+    {
+        std::lock_guard<std::mutex> lock(encoded->mutex);
+        gen = encoded->generation[key];
+    }
+
+    encoder->submit([this, img, lv, out, fmt, g, tx, ty, key, gen, done](){
+        auto t0 = std::chrono::steady_clock::now();
+        int cx = tx * tileSize, cy = ty * tileSize;
+        int w = (std::min(tileSize, lv.w - cx) + 2 * g + 3) & ~3;
+        int h = (std::min(tileSize, lv.h - cy) + 2 * g + 3) & ~3;
+
+        // the encoders take RGBA; gray and BGR are expanded here, per tile
+        std::vector<unsigned char> rgba((size_t)w * h * 4);
+        if(img->channels == 4 && !img->bgr){
+            fillTile(rgba.data(), lv, cx - g, cy - g, w, h, 4);
+        } else {
+            std::vector<unsigned char> native((size_t)w * h * img->channels);
+            fillTile(native.data(), lv, cx - g, cy - g, w, h, img->channels);
+            expandToRgba(native.data(), img->channels, img->bgr, rgba.data(), (size_t)w * h);
+        }
+
+        std::vector<unsigned char> blocks((size_t)(w / 4) * (h / 4) * blockBytes(fmt));
+        compressBlocks(rgba.data(), w, h, (size_t)w * 4, fmt, blocks.data());
+
+        {
+            // the pixels changed while we were reading them: a newer
+            // request for the same tile is already queued
+            std::lock_guard<std::mutex> lock(out->mutex);
+            if(out->generation[key] != gen)
+                return;
+
+            out->blocks[key] = std::move(blocks);
+        }
+        out->fresh = true;
+
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            counters.tilesEncoded++;
+            counters.encodeMs += std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - t0).count();
+        }
+
+        if(done)
+            done();
+    });
+}
+
+bool TiledImage::encodePending(uint64_t key){
+    if(format == TextureCompression::None || !submitted.count(key))
+        return false;
+
+    std::lock_guard<std::mutex> lock(encoded->mutex);
+    return !encoded->blocks.count(key);
+}
+
+TiledImage::Tile* TiledImage::upload(int level, int tx, int ty){
+    auto t0 = std::chrono::steady_clock::now();
+    const ImageLevel &lv = image->levels[level];
+    uint64_t key = tileKey(level, tx, ty);
+    int g = gutter();
+
+    // content rectangle of the tile in level pixels
+    int cx = tx * tileSize, cy = ty * tileSize;
+    int cw = std::min(tileSize, lv.w - cx);
+    int ch = std::min(tileSize, lv.h - cy);
+    int uw = cw + 2 * g, uh = ch + 2 * g;
+    size_t size = (size_t)uw * uh * image->channels;
+
+    // compressed tiles go up as whole blocks, once the encoder has them
+    std::unique_lock<std::mutex> lock;
+    const std::vector<unsigned char>* blocks = nullptr;
+    if(format != TextureCompression::None){
+        lock = std::unique_lock<std::mutex>(encoded->mutex);
+        auto it = encoded->blocks.find(key);
+        if(it == encoded->blocks.end()){
+            lock.unlock();
+            requestEncode(level, tx, ty);
+            return nullptr;
+        }
+
+        blocks = &it->second;
+        size = blocks->size();
+        uw = (uw + 3) & ~3;
+        uh = (uh + 3) & ~3;
+    }
+
+    // a stale tile keeps its texture and gets the new blocks
+    auto old = tiles.find(key);
+    Tile t;
+    if(old != tiles.end()){
+        t.tex = old->second.tex;
+        lru.erase(old->second.lru);
+    } else {
+        t.tex = acquireTexture();
+    }
+
+    // orphan the next buffer of the ring so the copy never waits for the
+    // transfer still in flight from a previous use
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    nextPbo = (nextPbo + 1) % pboCount;
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if(dst){
+        if(blocks)
+            memcpy(dst, blocks->data(), size);
+        else
+            fillTile((unsigned char*)dst, lv, cx - g, cy - g, uw, uh, image->channels);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+
+    if(lock.owns_lock())
+        lock.unlock();
+
+    glBindTexture(GL_TEXTURE_2D, t.tex);
+    if(blocks){
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, uw, uh, glFormat(), (GLsizei)size, 0);
+    } else {
+        GLint internal;
+        GLenum fmt;
+        textureFormat(texChannels, internal, fmt);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, uw, uh, fmt, GL_UNSIGNED_BYTE, 0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    float ts = (float)textureSize();
+    float sx = (float)image->w / lv.w;
+    float sy = (float)image->h / lv.h;
+    t.rect[0] = cx * sx;
+    t.rect[1] = cy * sy;
+    t.rect[2] = cw * sx;
+    t.rect[3] = ch * sy;
+    t.uvRect[0] = g / ts;
+    t.uvRect[1] = g / ts;
+    t.uvRect[2] = cw / ts;
+    t.uvRect[3] = ch / ts;
+    t.frame = frame;
+
+    lru.push_front(key);
+    t.lru = lru.begin();
+    uploads++;
+    counters.tilesUploaded++;
+    counters.bytesUploaded += size;
+    counters.uploadMs += std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+    return &(tiles[key] = t);
+}
+
+void TiledImage::refresh(Tile& t, int level, int tx, int ty, const ImageRect& r){
+    auto t0 = std::chrono::steady_clock::now();
+    const ImageLevel &lv = image->levels[level];
+    int g = gutter();
+
+    // the texture holds level pixels [cx - g, cx + cw + g); a change on
+    // the edge of the level also changes the gutter copied from it
+    int cx = tx * tileSize, cy = ty * tileSize;
+    int cw = std::min(tileSize, lv.w - cx);
+    int ch = std::min(tileSize, lv.h - cy);
+    int x0 = std::max(r.x0 > 0 ? r.x0 : -g, cx - g);
+    int y0 = std::max(r.y0 > 0 ? r.y0 : -g, cy - g);
+    int x1 = std::min(r.x1 < lv.w ? r.x1 : lv.w + g, cx + cw + g);
+    int y1 = std::min(r.y1 < lv.h ? r.y1 : lv.h + g, cy + ch + g);
+    if(x1 <= x0 || y1 <= y0)
+        return;
+
+    int w = x1 - x0, h = y1 - y0;
+    size_t size = (size_t)w * h * image->channels;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    nextPbo = (nextPbo + 1) % pboCount;
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if(dst){
+        fillTile((unsigned char*)dst, lv, x0, y0, w, h, image->channels);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        GLint internal;
+        GLenum fmt;
+        textureFormat(texChannels, internal, fmt);
+        glBindTexture(GL_TEXTURE_2D, t.tex);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x0 - (cx - g), y0 - (cy - g), w, h, fmt,
+                        GL_UNSIGNED_BYTE, 0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    counters.bytesUploaded += size;
+    counters.uploadMs += std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+void TiledImage::invalidate(const std::vector<ImageRect>& rects){
+    if(!image)
+        return;
+
+    // Auto picked BC1 for an opaque image that no longer is
+    if(requested == TextureCompression::Auto && format == TextureCompression::BC1 && !image->opaque){
+        std::shared_ptr<Image> img = image;
+        setImage(img);
+        return;
+    }
+
+    int g = gutter();
+    int levels = std::min((int)rects.size(), (int)image->levels.size());
+    for(int level = 0; level < levels; level++){
+        const ImageRect &r = rects[level];
+        const ImageLevel &lv = image->levels[level];
+        if(r.empty())
+            continue;
+
+        // every tile whose content or gutter overlaps r
+        int tx0 = std::max(0, (r.x0 - g) / tileSize);
+        int ty0 = std::max(0, (r.y0 - g) / tileSize);
+        int tx1 = std::min((lv.w - 1) / tileSize, (r.x1 - 1 + g) / tileSize);
+        int ty1 = std::min((lv.h - 1) / tileSize, (r.y1 - 1 + g) / tileSize);
+        for(int ty = ty0; ty <= ty1; ty++){
+            for(int tx = tx0; tx <= tx1; tx++){
+                uint64_t key = tileKey(level, tx, ty);
+                auto it = tiles.find(key);
+                if(format == TextureCompression::None){
+                    if(it != tiles.end())
+                        refresh(it->second, level, tx, ty, r);
+                    continue;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(encoded->mutex);
+                    encoded->blocks.erase(key);
+                    encoded->generation[key]++;
+                }
+                submitted.erase(key);
+                if(it != tiles.end()){
+                    it->second.stale = true;
+                    requestEncode(level, tx, ty);
+                }
+            }
+        }
+    }
+}
+
+void TiledImage::drawTile(const Tile& t){
+    glUniform4fv(locRect, 1, t.rect);
+    glUniform4fv(locUVRect, 1, t.uvRect);
+    glBindTexture(GL_TEXTURE_2D, t.tex);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+}
+
+void TiledImage::draw(float x0, float y0, float x1, float y1, float zoom, GLuint quadVAO){
+    if(!image || x1 <= x0 || y1 <= y0)
+        return;
+
+    int level = levelForZoom(zoom);
+    int top = (int)image->levels.size() - 1;
+    const ImageLevel &lv = image->levels[level];
+    float sx = (float)image->w / lv.w;
+    float sy = (float)image->h / lv.h;
+
+    int tx0 = std::max(0, (int)(x0 / sx) / tileSize);
+    int ty0 = std::max(0, (int)(y0 / sy) / tileSize);
+    int tx1 = std::min((lv.w - 1) / tileSize, (int)(x1 / sx) / tileSize);
+    int ty1 = std::min((lv.h - 1) / tileSize, (int)(y1 / sy) / tileSize);
+
+    std::vector<const Tile*> visible;
+    std::vector<uint64_t> fallback;
+    for(int ty = ty0; ty <= ty1; ty++){
+        for(int tx = tx0; tx <= tx1; tx++){
+            uint64_t key = tileKey(level, tx, ty);
+            Tile *t = find(key);
+            if(t && t->stale){
+                // the old content stays up until the new blocks are in
+                if(encodePending(key))
+                    waiting = true;
+                else if(uploads >= maxUploadsPerFrame)
+                    missing = true;
+                else if(Tile *fresh = upload(level, tx, ty))
+                    t = fresh;
+            } else if(!t && uploads < maxUploadsPerFrame)
+                t = upload(level, tx, ty);
+
+            if(t){
+                visible.push_back(t);
+                continue;
+            }
+
+            // not resident yet: cover the hole with the nearest coarser
+            // tile that is, down to the pinned top level
+            if(encodePending(key))
+                waiting = true;
+            else
+                missing = true;
+            for(int l = level + 1; l <= top; l++){
+                int shift = l - level;
+                uint64_t pk = tileKey(l, tx >> shift, ty >> shift);
+                if(find(pk)){
+                    fallback.push_back(pk);
+                    break;
+                }
+
+                if(l == top && uploads < maxUploadsPerFrame && upload(top, 0, 0))
+                    fallback.push_back(pk);
+            }
+        }
+    }
+
+    glBindVertexArray(quadVAO);
+    glActiveTexture(GL_TEXTURE0);
+
+    // coarser fallbacks first so the sharp tiles end up on top
+    std::sort(fallback.begin(), fallback.end());
+    fallback.erase(std::unique(fallback.begin(), fallback.end()), fallback.end());
+    for(auto it = fallback.rbegin(); it != fallback.rend(); ++it)
+        drawTile(*find(*it));
+
+    for(const Tile *t : visible)
+        drawTile(*t);
+}
@@ -0,0 +1,181 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef TILEDIMAGE_H
+#define TILEDIMAGE_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "image.hpp"
+#include "resample.hpp"
+#include "texcompress.hpp"
+#include "threadpool.hpp"
+
+// Texture format for pixels of n channels. Fewer than four are kept as
+// R8 / RG8 / RGB8, a quarter to three quarters of RGBA8, and
+// textureSwizzle() makes the bound texture sample as gray, gray + alpha
+// or opaque RGB, with red and blue exchanged for BGR pixels.
+void textureFormat(int channels, GLint& internal, GLenum& format);
+void textureSwizzle(int channels, bool bgr);
+
+// Virtual texture over an Image pyramid. The image is cut into
+// tileSize x tileSize tiles per mip level and only the tiles that are
+// actually drawn are kept on the GPU, in an LRU cache bounded by a byte
+// budget. The coarsest level is a single tile and stays pinned, so there
+// is always something to fall back to while finer tiles stream in.
+//
+// Tiles are streamed through a small ring of pixel buffer objects and
+// every tile texture has the same size, so evicted textures are recycled
+// with glTexSubImage2D instead of being reallocated.
+//
+// With compression enabled, tiles are BC1/BC7 encoded on worker threads
+// the first time they are wanted and the blocks are kept for the life of
+// the image, so an evicted tile costs only an upload when it comes back.
+// Until a tile is encoded the coarser fallback is drawn in its place.
+class TiledImage{
+public:
+    static constexpr int tileSize = 512;
+    static constexpr int gutterSize = resampleReach;    // neighbours' pixels on every side
+    static constexpr int texSize = tileSize + 2 * gutterSize;
+    static constexpr int blockTexSize = (texSize + 3) & ~3;     // whole blocks
+    static constexpr int maxUploadsPerFrame = 8;
+    static constexpr int pboCount = 4;
+
+    struct Stats{
+        size_t tilesUploaded = 0;
+        size_t bytesUploaded = 0;
+        double uploadMs = 0.0;      // CPU time spent staging and submitting
+        size_t tilesEncoded = 0;
+        double encodeMs = 0.0;      // CPU time on the encoder threads
+    };
+
+    // Caches the uRect / uUVRect uniform locations of the tile program
+    // and creates the upload ring.
+    void init(GLuint program);
+    void setImage(std::shared_ptr<Image> img);
+    void setBudget(size_t bytes);
+    // Tile format for images set from now on. Falls back to RGBA8 when
+    // the context lacks the extension or the image is not RGBA.
+    void setCompression(TextureCompression mode);
+    // Called from an encoder thread whenever a tile is ready to upload.
+    void setNotify(std::function<void()> fn) { notify = std::move(fn); }
+    // Drops every tile; destroy() also frees the upload ring.
+    void release();
+    void destroy();
+
+    // The image's pixels changed inside rects (one per level, as returned
+    // by updateRegion). Resident RGBA tiles get just that part re-uploaded;
+    // compressed tiles are re-encoded and swapped in when ready, showing
+    // their old content until then.
+    void invalidate(const std::vector<ImageRect>& rects);
+
+    // Call once per rendered frame before any draw().
+    void beginFrame();
+
+    // Draws the part of the image covering [x0, x1] x [y0, y1] (image
+    // pixels) at the mip level matching zoom. The tile program must be
+    // bound with uProj / uPan / uZoom already set, and quadVAO is the unit
+    // quad the tiles are stretched from.
+    void draw(float x0, float y0, float x1, float y1, float zoom, GLuint quadVAO);
+
+    int levelForZoom(float zoom) const;
+    // A frame drawn now would upload something that is still missing.
+    bool pending() const { return missing || (encoded && encoded->fresh); }
+    // Wanted tiles are still being encoded.
+    bool encoding() const { return waiting; }
+    // VRAM held by tile textures, spares included
+    size_t residentBytes() const { return bytes; }
+    // What the same textures would take as RGBA8
+    size_t uncompressedBytes() const;
+    TextureCompression compression() const { return format; }
+    Stats stats() const;
+
+private:
+    struct Tile{
+        GLuint tex = 0;
+        float rect[4];
+        float uvRect[4];
+        unsigned frame = 0;
+        bool stale = false;         // re-encode of changed pixels on its way
+        std::list<uint64_t>::iterator lru;
+    };
+
+    // Encoded tiles of one image, shared with the encoder threads.
+    struct EncodedTiles{
+        std::mutex mutex;
+        std::unordered_map<uint64_t, std::vector<unsigned char>> blocks;
+        std::unordered_map<uint64_t, unsigned> generation;  // bumped when pixels change
+        std::atomic<bool> fresh{false};     // blocks added since the last frame
+    };
+
+    static uint64_t tileKey(int level, int tx, int ty);
+    Tile* find(uint64_t key);
+    Tile* upload(int level, int tx, int ty);
+    void requestEncode(int level, int tx, int ty);
+    bool encodePending(uint64_t key);
+    void refresh(Tile& t, int level, int tx, int ty, const ImageRect& r);
+    GLuint acquireTexture();
+    int gutter() const { return gutterSize; }
+    int textureSize() const { return format == TextureCompression::None ? texSize : blockTexSize; }
+    GLenum glFormat() const;
+    static void fillTile(unsigned char* dst, const ImageLevel& lv, int x0, int y0, int w, int h,
+                         int channels);
+    void drawTile(const Tile& t);
+
+    std::shared_ptr<Image> image;
+    std::unordered_map<uint64_t, Tile> tiles;
+    std::list<uint64_t> lru;            // front = most recently used
+    std::vector<GLuint> spare;          // textures left over from the last image
+    size_t budget = size_t(512) << 20;
+    size_t bytes = 0;
+    size_t tileBytes = 0;
+    unsigned frame = 0;
+    int uploads = 0;
+    bool missing = false;
+    bool waiting = false;
+    Stats counters;
+    mutable std::mutex statsMutex;      // encoder threads add to counters
+
+    TextureCompression requested = TextureCompression::None;
+    TextureCompression format = TextureCompression::None;    // of the current textures
+    int texChannels = 4;                // of the current uncompressed textures
+    bool texBgr = false;
+    bool hasBC1 = false, hasBC7 = false;
+    std::shared_ptr<EncodedTiles> encoded;
+    std::unordered_set<uint64_t> submitted;     // keys handed to the encoder
+    std::unique_ptr<ThreadPool> encoder;
+    std::function<void()> notify;
+
+    GLuint pbos[pboCount] = {};
+    int nextPbo = 0;
+
+    GLint locRect = -1, locUVRect = -1;
+};
+
+#endif // TILEDIMAGE_H
@@ -0,0 +1,1816 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#include "viewer.hpp"
+#include "diskcache.hpp"
+#include "mipmap.hpp"
+#include "shader.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+static inline Vec2 operator-(const Vec2 &a, const Vec2 &b){
+    return Vec2(a.x - b.x, a.y - b.y);
+}
+
+static inline Vec2 operator+(const Vec2 &a, const Vec2 &b){
+    return Vec2(a.x + b.x, a.y + b.y);
+}
+
+static inline Vec2 operator*(const Vec2 &a, float s){
+    return Vec2(a.x * s, a.y * s);
+}
+
+static inline float clampf(float v, float a, float b){
+    return v < a ? a : (v > b ? b : v);
+}
+
+static const float stiffness = 250.0f;
+static const float damping = 25.0f;
+
+static const char* vs_src = R"(
+#version 330 core
+layout(location=0) in vec2 aPos;
+uniform mat4 uProj;
+uniform vec2 uPan;
+uniform float uZoom;
+uniform vec4 uRect;
+uniform vec4 uUVRect;
+uniform mat3 uOrient;
+out vec2 vUV;
+void main(){
+    // stored image coordinates turned onto the screen; UVs stay stored
+    vec2 pos = (uOrient * vec3(uRect.xy + aPos * uRect.zw, 1.0)).xy * uZoom + uPan;
+    gl_Position = uProj * vec4(pos.xy, 0.0, 1.0);
+    vUV = uUVRect.xy + aPos * uUVRect.zw;
+}
+)";
+
+struct Mat4{
+    float d[16];
+    static Mat4 ortho(float l, float r, float b, float t){
+        Mat4 m{};
+        m.d[0]  = 2.0f / (r - l);
+        m.d[5]  = 2.0f / (t - b);
+        m.d[10] = -1.0f;
+        m.d[12] = -(r + l) / (r - l);
+        m.d[13] = -(t + b) / (t - b);
+        m.d[15] = 1.0f;
+        return m;
+    }
+};
+
+static double msSince(std::chrono::steady_clock::time_point t){
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+}
+
+// GLFW callbacks find their Viewer through the window user pointer.
+
+static Viewer* viewerOf(GLFWwindow* w){
+    return (Viewer*)glfwGetWindowUserPointer(w);
+}
+
+static void framebufferSizeCallback(GLFWwindow* w, int width, int height){
+    viewerOf(w)->resize(width, height);
+}
+
+static void mouseButtonCallback(GLFWwindow* w, int button, int action, int mods){
+    double mx, my;
+    glfwGetCursorPos(w, &mx, &my);
+    viewerOf(w)->mouseButton(button, action, mx, my);
+}
+
+static void cursorCallback(GLFWwindow* w, double xpos, double ypos){
+    viewerOf(w)->cursor(xpos, ypos);
+}
+
+static void scrollCallback(GLFWwindow* w, double xoffset, double yoffset){
+    double mx, my;
+    glfwGetCursorPos(w, &mx, &my);
+    viewerOf(w)->scroll(mx, my, yoffset);
+}
+
+static void keyCallback(GLFWwindow* w, int key, int scancode, int action, int mods){
+    viewerOf(w)->key(key, action, mods);
+}
+
+static void windowRefreshCallback(GLFWwindow* w){
+    viewerOf(w)->redraw();
+}
+
+Viewer::Viewer(ViewerGroup& g, GLFWwindow* window, int width, int height):
+    group(g), win(window), winW(width), winH(height) {}
+
+Viewer::~Viewer(){
+    if(win)
+        glfwDestroyWindow(win);
+}
+
+void Viewer::makeCurrent() const {
+    if(win && glfwGetCurrentContext() != win)
+        glfwMakeContextCurrent(win);
+}
+
+void Viewer::initGL(bool primary){
+    // VAOs are not shared between contexts; the buffers behind them are
+    glGenVertexArrays(1, &quadVAO);
+    glBindVertexArray(quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, group.quadVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, group.quadEBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
+    glBindVertexArray(0);
+    group.sheet.createView(group.quadVBO, group.quadEBO, sheetVAO, sheetInstances);
+
+    overlay.init();
+    profiler.init();
+    stats.setNotify(glfwPostEmptyEvent);
+    showHud = group.options.hud;
+    filter = group.options.resample;
+    pacer.setMode(group.options.pacing);
+    if(primary && !group.options.tracePath.empty())
+        profiler.openTrace(group.options.tracePath);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void Viewer::destroyGL(){
+    if(group.options.hud || !group.options.tracePath.empty())
+        profiler.printSummary();
+
+    overlay.destroy();
+    profiler.destroy();
+    pacer.destroy();
+    group.sheet.destroyView(sheetVAO, sheetInstances);
+    glDeleteVertexArrays(1, &quadVAO);
+    quadVAO = 0;
+}
+
+Vec2 Viewer::toScreen(double x, double y) const {
+    return Vec2((float)x, (float)(winH - y));
+}
+
+float Viewer::contentW() const {
+    return grid ? sheetLayout().width() : (float)group.imgW;
+}
+
+float Viewer::contentH() const {
+    return grid ? sheetLayout().height() : (float)group.imgH;
+}
+
+Vec2 Viewer::clampedPan(const Vec2 &p, float z) const {
+    float dispW = contentW() * z;
+    float dispH = contentH() * z;
+    float minX, maxX, minY, maxY;
+    if(dispW > winW){
+        minX = winW - dispW;
+        maxX = 0.0f;
+    } else {
+        float cx = (winW - dispW) * 0.5f;
+        minX = maxX = cx;
+    }
+
+    if(dispH > winH){
+        minY = winH - dispH;
+        maxY = 0.0f;
+    } else if(grid){
+        // a short sheet hangs from the top
+        minY = maxY = winH - dispH;
+    } else {
+        float cy = (winH - dispH) * 0.5f;
+        minY = maxY = cy;
+    }
+
+    float cx = clampf(p.x, minX, maxX);
+    float cy = clampf(p.y, minY, maxY);
+    return Vec2(cx, cy);
+}
+
+Vec2 Viewer::screenToImage(const Vec2 &s) const {
+    return Vec2((s.x - pan.x) / zoomLevel, (s.y - pan.y) / zoomLevel );
+}
+
+void Viewer::centerImage(const Vec2 &imgPt){
+    Vec2 center(winW * 0.5f, winH * 0.5f);
+    Vec2 newPan(center.x - imgPt.x * zoomLevel, center.y - imgPt.y * zoomLevel);
+    targetPan = clampedPan(newPan, zoomLevel);
+    pan = targetPan;
+    panVel = Vec2(0, 0);
+}
+
+void Viewer::centerFromMinimap(const Vec2 &s){
+    int imgW = group.imgW, imgH = group.imgH;
+    float localX = s.x - birdeyeX;
+    float localY = s.y - birdeyeY;
+
+    float sx = (float)birdeyeW / imgW;
+    float sy = (float)birdeyeH / imgH;
+
+    float birdZoom = fmin(sx, sy);
+    float imgDisplayW = imgW * birdZoom;
+    float imgDisplayH = imgH * birdZoom;
+
+    float birdPanX = (birdeyeW - imgDisplayW) * 0.5f;
+    float birdPanY = (birdeyeH - imgDisplayH) * 0.5f;
+
+    float imgX = (localX - birdPanX) / birdZoom;
+    float imgY = (localY - birdPanY) / birdZoom;
+
+    imgX = clampf(imgX, 0.0f, (float)imgW);
+    imgY = clampf(imgY, 0.0f, (float)imgH);
+
+    centerImage(Vec2(imgX, imgY));
+}
+
+void Viewer::updateBirdeyeDims(){
+    birdeyeW = 220;
+    birdeyeH = group.imgW ? int(round((float)birdeyeW * ((float)group.imgH / (float)group.imgW))) : 0;
+    birdeyeX = winW - birdeyeW - birdeyeMargin;
+    birdeyeY = birdeyeMargin;
+}
+
+void Viewer::fitView(){
+    // done on the way out of the grid
+    if(grid){
+        refitImage = true;
+        updateBirdeyeDims();
+        return;
+    }
+
+    pan.x = (winW - group.imgW) * 0.5f;
+    pan.y = (winH - group.imgH) * 0.5f;
+    targetPan = clampedPan(pan, zoomLevel);
+    panVel = Vec2(0,0);
+
+    updateBirdeyeDims();
+    needsRedraw = true;
+}
+
+void Viewer::resize(int width, int height){
+    winW = width;
+    winH = height;
+
+    if(grid){
+        targetPan = clampedPan(targetPan, 1.0f);
+        pan = targetPan;
+        panVel = Vec2(0, 0);
+        updateBirdeyeDims();
+        needsRedraw = true;
+        return;
+    }
+
+    float imgWidth = group.imgW * zoomLevel;
+    float imgHeight = group.imgH * zoomLevel;
+
+    if (imgWidth <= winW) {
+        pan.x = (winW - imgWidth) / 2.0f;
+        targetPan.x = pan.x;
+    } else {
+        if (pan.x > 0) {
+            pan.x = 0;
+            targetPan.x = pan.x;
+        }
+
+        if (pan.x + imgWidth < winW) {
+            pan.x = winW - imgWidth;
+            targetPan.x = pan.x;
+        }
+    }
+
+    if (imgHeight <= winH) {
+        pan.y = (winH - imgHeight) / 2.0f;
+        targetPan.y = pan.y;
+    } else {
+        if (pan.y > 0) {
+            pan.y = 0;
+            targetPan.y = pan.y;
+        }
+
+        if (pan.y + imgHeight < winH) {
+            pan.y = winH - imgHeight;
+            targetPan.y = pan.y;
+        }
+    }
+
+    updateBirdeyeDims();
+    needsRedraw = true;
+}
+
+void Viewer::mouseButton(int button, int action, double x, double y){
+    if(!grid && !group.hasContent())
+        return;
+
+    Vec2 s = toScreen(x, y);
+    needsRedraw = true;
+    inputEvent();
+
+    // the drag ends where the button went up, not at the last sample
+    if(cursorMoved){
+        moveCursor(s);
+        cursorMoved = false;
+    }
+
+    // in the grid a drag scrolls and a click opens the image under it
+    if(grid && button == GLFW_MOUSE_BUTTON_LEFT){
+        if(action == GLFW_PRESS){
+            leftDown = true;
+            draggingMain = true;
+            panVel = Vec2(0, 0);
+            lastMouseX = pressX = s.x;
+            lastMouseY = pressY = s.y;
+        } else if(action == GLFW_RELEASE){
+            leftDown = false;
+            draggingMain = false;
+            targetPan = clampedPan(pan, 1.0f);
+            if(fabs(s.x - pressX) < 4.0 && fabs(s.y - pressY) < 4.0){
+                int i = group.sheet.cellAt(sheetLayout(), s.x - pan.x, s.y - pan.y);
+                if(i >= 0 && i != group.playlist.index())
+                    group.playlist.seek(i);
+                if(i >= 0)
+                    setGrid(false);
+            }
+        }
+
+        return;
+    }
+
+    if(button == GLFW_MOUSE_BUTTON_LEFT){
+        if(action == GLFW_PRESS){
+            leftDown=true;
+            lastMouseX = s.x;
+            lastMouseY = s.y;
+
+            if(s.x >= birdeyeX && s.x <= birdeyeX + birdeyeW &&
+                s.y >= birdeyeY && s.y <= birdeyeY + birdeyeH){
+                draggingBird = true;
+                draggingMain = false;
+                panVel = Vec2(0, 0);
+                centerFromMinimap(s);
+            } else {
+                draggingMain = true;
+                draggingBird = false;
+                panVel = Vec2(0, 0);
+            }
+        } else if(action==GLFW_RELEASE){
+            leftDown = false;
+            if(draggingMain || draggingMain)
+                targetPan = clampedPan(pan, zoomLevel);
+
+            draggingMain = false;
+            draggingBird = false;
+        }
+    }
+}
+
+void Viewer::cursor(double x, double y){
+    if(leftDown && (draggingMain || draggingBird) && win && group.options.lateInput){
+        cursorMoved = true;
+        needsRedraw = true;
+        return;
+    }
+
+    moveCursor(toScreen(x, y));
+}
+
+void Viewer::moveCursor(const Vec2 &cur){
+    if(leftDown && (draggingMain || draggingBird))
+        inputEvent();
+
+    if(leftDown && draggingMain){
+        float dx = cur.x - (float)lastMouseX;
+        float dy = cur.y - (float)lastMouseY;
+
+        pan.x += dx;
+        pan.y += dy;
+
+        lastMouseX = cur.x;
+        lastMouseY = cur.y;
+        needsRedraw = true;
+    } else if(leftDown && draggingBird){
+        centerFromMinimap(cur);
+        needsRedraw = true;
+    } else {
+        lastMouseX = cur.x;
+        lastMouseY = cur.y;
+    }
+}
+
+void Viewer::zoomAt(const Vec2 &s, double yoffset){
+    if(grid){
+        zoomGrid(s, yoffset);
+        return;
+    }
+
+    if(!group.hasContent())
+        return;
+
+    int imgW = group.imgW, imgH = group.imgH;
+    Vec2 worldBefore = screenToImage(s);
+    float factor = exp((float)yoffset * 0.18f);
+    float newZoom = clampf(zoomLevel * factor, 0.05f, 20.0f);
+    zoomLevel = newZoom;
+    pan.x = s.x - worldBefore.x * zoomLevel;
+    pan.y = s.y - worldBefore.y * zoomLevel;
+    if (imgW * zoomLevel <= winW)
+        pan.x = (winW - imgW * zoomLevel) / 2;
+
+    if (imgH * zoomLevel <= winH)
+        pan.y = (winH - imgH * zoomLevel) / 2;
+
+    targetPan = clampedPan(pan, zoomLevel);
+    needsRedraw = true;
+}
+
+void Viewer::scroll(double x, double y, double yoffset){
+    // the wheel scrolls the grid a row a notch, Ctrl + wheel resizes it
+    bool ctrl = win && (glfwGetKey(win, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS ||
+                        glfwGetKey(win, GLFW_KEY_RIGHT_CONTROL) == GLFW_PRESS);
+    inputEvent();
+    if(grid && !ctrl){
+        targetPan.y -= (float)yoffset * sheetLayout().cell;
+        targetPan = clampedPan(targetPan, 1.0f);
+        needsRedraw = true;
+        return;
+    }
+
+    zoomAt(toScreen(x, y), yoffset);
+}
+
+void Viewer::key(int key, int action, int mods){
+    if (action == GLFW_PRESS || action == GLFW_REPEAT) {
+        inputEvent();
+        Playlist& playlist = group.playlist;
+        if (key == GLFW_KEY_G && action == GLFW_PRESS && group.sheet.size() > 0) {
+            setGrid(!grid);
+            return;
+        }
+
+        if (grid) {
+            if (!(mods & GLFW_MOD_CONTROL))
+                gridKey(key);
+        } else if (playlist.size() > 1) {
+            if (key == GLFW_KEY_RIGHT || key == GLFW_KEY_PAGE_DOWN)
+                playlist.step(1);
+
+            if (key == GLFW_KEY_LEFT || key == GLFW_KEY_PAGE_UP)
+                playlist.step(-1);
+
+            if (key == GLFW_KEY_HOME)
+                playlist.seek(0);
+
+            if (key == GLFW_KEY_END)
+                playlist.seek(playlist.size() - 1);
+        }
+
+        if (key == GLFW_KEY_F1 && action == GLFW_PRESS) {
+            showHud = !showHud;
+            needsRedraw = true;
+        }
+
+        if (key == GLFW_KEY_Q && action == GLFW_PRESS) {
+            filter = (ResampleFilter)(((int)filter + 1) % 4);
+            needsRedraw = true;
+            lastTitle = 0.0;
+        }
+
+        // quarter turns (Shift for counter-clockwise) and mirroring, all
+        // in the vertex shader
+        if (key == GLFW_KEY_R && action == GLFW_PRESS && !grid && !(mods & GLFW_MOD_CONTROL)) {
+            Orientation cw = Orientation::turnCW();
+            group.reorient((mods & GLFW_MOD_SHIFT) ? cw.then(cw).then(cw) : cw);
+        }
+
+        if (key == GLFW_KEY_M && action == GLFW_PRESS && !grid && !(mods & GLFW_MOD_CONTROL))
+            group.reorient(Orientation::mirrorX());
+
+        if (key == GLFW_KEY_SPACE && action == GLFW_PRESS && group.animation.active())
+            group.animation.setPaused(!group.animation.paused());
+
+        // histogram of what is on screen, of the whole image, or none
+        if (key == GLFW_KEY_H && action == GLFW_PRESS) {
+            statsView = statsView == StatsView::Off ? StatsView::Visible :
+                        statsView == StatsView::Visible ? StatsView::Whole : StatsView::Off;
+            statsImage = 0;
+            needsRedraw = true;
+            if (win && statsView == StatsView::Off)
+                glfwSetWindowTitle(win, group.title.c_str());
+        }
+
+        // the view at print size, written between frames
+        if ((mods & GLFW_MOD_CONTROL) && key == GLFW_KEY_E && action == GLFW_PRESS && !grid)
+            group.exportRequested = this;
+
+        // another window on the same image, opened after the events
+        if ((mods & GLFW_MOD_CONTROL) && key == GLFW_KEY_N && action == GLFW_PRESS && win)
+            group.openRequested = true;
+
+        if ((mods & GLFW_MOD_CONTROL) &&
+            (key == GLFW_KEY_EQUAL || key == GLFW_KEY_KP_ADD))
+            zoomAt(Vec2((float)lastMouseX, (float)lastMouseY), 0.36);
+
+        if ((mods & GLFW_MOD_CONTROL) &&
+            (key == GLFW_KEY_MINUS || key == GLFW_KEY_KP_SUBTRACT))
+            zoomAt(Vec2((float)lastMouseX, (float)lastMouseY), -0.36);
+    }
+}
+
+void Viewer::updateSpring(float dt){
+    Vec2 disp = pan - targetPan;
+    float ax = -stiffness * disp.x - damping * panVel.x;
+    float ay = -stiffness * disp.y - damping * panVel.y;
+    panVel.x += ax * dt;
+    panVel.y += ay * dt;
+    pan.x += panVel.x * dt;
+    pan.y += panVel.y * dt;
+
+    if(fabs(disp.x) < 0.5f && fabs(panVel.x) < 0.5f) {
+        pan.x = targetPan.x;
+        panVel.x = 0.0f;
+    }
+
+    if(fabs(disp.y) < 0.5f && fabs(panVel.y) < 0.5f){
+        pan.y = targetPan.y;
+        panVel.y = 0.0f;
+    }
+}
+
+ContactSheet::Layout Viewer::sheetLayout() const {
+    return group.sheet.layout(winW, winH, cellSize);
+}
+
+void Viewer::setGrid(bool on){
+    if(on == grid)
+        return;
+
+    leftDown = draggingMain = draggingBird = false;
+    panVel = Vec2(0, 0);
+    needsRedraw = true;
+
+    if(on){
+        imagePan = targetPan;
+        imageZoom = zoomLevel;
+        grid = true;
+        zoomLevel = 1.0f;
+        targetPan = clampedPan(Vec2(0.0f, winH - contentH()), 1.0f);
+        revealCell(group.playlist.index());
+        pan = targetPan;
+        return;
+    }
+
+    grid = false;
+    zoomLevel = imageZoom;
+    pan = targetPan = imagePan;
+    if(refitImage)
+        fitView();
+    else
+        resize(winW, winH);
+    refitImage = false;
+}
+
+// Springs the sheet just far enough to bring cell i fully on screen.
+void Viewer::revealCell(int i){
+    ContactSheet::Layout l = sheetLayout();
+    if(i < 0 || i >= l.count)
+        return;
+
+    float x, y;
+    group.sheet.cellOrigin(l, i, x, y);
+    if(y + targetPan.y < 0.0f)
+        targetPan.y = -y;
+    if(y + l.cell + targetPan.y > winH)
+        targetPan.y = winH - y - l.cell;
+
+    targetPan = clampedPan(targetPan, 1.0f);
+    needsRedraw = true;
+}
+
+// Moves the selection, which is the playlist position, so the image
+// picked is already decoding when the grid is left.
+void Viewer::gridKey(int key){
+    Playlist& playlist = group.playlist;
+    ContactSheet::Layout l = sheetLayout();
+    int i = playlist.index();
+    int page = l.cols * std::max(1, (int)(winH / l.cell));
+    int to = i;
+
+    if (key == GLFW_KEY_RIGHT)
+        to = i + 1;
+    if (key == GLFW_KEY_LEFT)
+        to = i - 1;
+    if (key == GLFW_KEY_DOWN)
+        to = i + l.cols;
+    if (key == GLFW_KEY_UP)
+        to = i - l.cols;
+    if (key == GLFW_KEY_PAGE_DOWN)
+        to = i + page;
+    if (key == GLFW_KEY_PAGE_UP)
+        to = i - page;
+    if (key == GLFW_KEY_HOME)
+        to = 0;
+    if (key == GLFW_KEY_END)
+        to = l.count - 1;
+
+    if (key == GLFW_KEY_ENTER || key == GLFW_KEY_ESCAPE) {
+        setGrid(false);
+        return;
+    }
+
+    to = std::min(std::max(to, 0), l.count - 1);
+    if (to != i) {
+        playlist.seek(to);
+        revealCell(to);
+    }
+}
+
+// Resizes the cells about s, keeping the row under it in place.
+void Viewer::zoomGrid(const Vec2 &s, double yoffset){
+    ContactSheet::Layout before = sheetLayout();
+    float fromTop = before.height() - (s.y - pan.y);
+    float row = clampf(fromTop / before.cell, 0.0f, (float)before.rows);
+    int first = (int)row * before.cols;
+
+    cellSize = clampf(before.cell * exp((float)yoffset * 0.18f), 48.0f, 2.0f * ContactSheet::thumbSize);
+    ContactSheet::Layout after = sheetLayout();
+    cellSize = after.cell;
+    float newRow = first / after.cols + (row - (int)row);
+
+    pan.y = s.y - after.height() + newRow * after.cell;
+    targetPan = clampedPan(pan, 1.0f);
+    needsRedraw = true;
+}
+
+bool Viewer::springSettled() const {
+    return panVel.x == 0.0f && panVel.y == 0.0f &&
+           pan.x == targetPan.x && pan.y == targetPan.y;
+}
+
+void Viewer::inputEvent(){
+    if(inputPending)
+        return;
+
+    inputPending = true;
+    inputTime = std::chrono::steady_clock::now();
+}
+
+void Viewer::inputShown(){
+    if(!inputPending)
+        return;
+
+    inputPending = false;
+    group.inputLatency.add(msSince(inputTime));
+}
+
+void Viewer::sampleCursor(){
+    if(!cursorMoved)
+        return;
+
+    cursorMoved = false;
+    double x, y;
+    glfwGetCursorPos(win, &x, &y);
+    moveCursor(toScreen(x, y));
+}
+
+bool Viewer::moving() const {
+    return draggingMain || !springSettled();
+}
+
+bool Viewer::busy() const {
+    return needsRedraw || (!draggingMain && !springSettled());
+}
+
+void Viewer::beginFrame(){
+    makeCurrent();
+    // the previous frame is done on the GPU before new input is read
+    pacer.wait();
+    profiler.beginFrame();
+    profiler.begin(FrameProfiler::Events);
+}
+
+// Everything between the clear and the swap: the image, the minimap and
+// the overlays.
+void Viewer::draw(){
+    glViewport(0,0,winW,winH);
+    glClearColor(0.12f,0.12f,0.12f,1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if(grid){
+        drawGrid();
+        return;
+    }
+
+    if(!group.hasContent())
+        return;
+
+    int imgW = group.imgW, imgH = group.imgH;
+    Mat4 proj = Mat4::ortho(0.0f, (float)winW, 0.0f, (float)winH);
+
+    Vec2 visMin, visMax;
+    Vec2 s0(0, 0), s1((float)winW, (float)winH);
+    Vec2 i0 = Vec2((s0.x - pan.x) / zoomLevel, (s0.y - pan.y) / zoomLevel);
+    Vec2 i1 = Vec2((s1.x - pan.x) / zoomLevel, (s1.y - pan.y) / zoomLevel);
+    visMin.x = fmin(i0.x, i1.x);
+    visMin.y = fmin(i0.y, i1.y);
+    visMax.x = fmax(i0.x, i1.x);
+    visMax.y = fmax(i0.y, i1.y);
+
+    visMin.x = clampf(visMin.x, 0.0f, (float)imgW);
+    visMin.y = clampf(visMin.y, 0.0f, (float)imgH);
+    visMax.x = clampf(visMax.x, 0.0f, (float)imgW);
+    visMax.y = clampf(visMax.y, 0.0f, (float)imgH);
+
+    // tiles and statistics work on the image as stored
+    Vec2 storedMin, storedMax;
+    group.toStored(visMin, visMax, storedMin, storedMax);
+    if(statsView != StatsView::Off)
+        requestStats(storedMin, storedMax);
+
+    profiler.begin(FrameProfiler::Main);
+    glUseProgram(group.program);
+    glUniformMatrix4fv(group.locProj, 1, GL_FALSE, proj.d);
+    glUniform2f(group.locPan, pan.x, pan.y);
+    glUniform1f(group.locZoom, zoomLevel);
+    group.setOrientUniform();
+
+    // the chosen kernel at rest, one bilinear fetch while moving; nearest
+    // costs no more and keeps its pixels. Live frames have no gutter and
+    // are always bilinear.
+    ResampleFilter f = filter;
+    if(moving() && f != ResampleFilter::Nearest)
+        f = ResampleFilter::Bilinear;
+    coarseFrame = f != filter;
+    if(group.streaming)
+        f = ResampleFilter::Bilinear;
+    glUniform1i(group.locFilter, (int)f);
+    glUniform1f(group.locGrid, f == ResampleFilter::Nearest && zoomLevel >= pixelGridZoom ? 0.35f : 0.0f);
+    if(group.streaming)
+        group.streamTex.draw(quadVAO);
+    else
+        group.tiles.draw(storedMin.x, storedMin.y, storedMax.x, storedMax.y, zoomLevel, quadVAO);
+    profiler.end(FrameProfiler::Main);
+
+    profiler.begin(FrameProfiler::Minimap);
+    glViewport(birdeyeX, birdeyeY, birdeyeW, birdeyeH);
+    Mat4 birdProj = Mat4::ortho(0.0f, (float)birdeyeW, 0.0f, (float)birdeyeH);
+
+    float sx = (float)birdeyeW / (float)imgW;
+    float sy = (float)birdeyeH / (float)imgH;
+
+    float birdZoom = fmin(sx, sy);
+    float imgDisplayW = imgW * birdZoom;
+    float imgDisplayH = imgH * birdZoom;
+
+    float birdPanX = ((float)birdeyeW - imgDisplayW) * 0.5f;
+    float birdPanY = ((float)birdeyeH - imgDisplayH) * 0.5f;
+
+    glUseProgram(group.program);
+    glUniformMatrix4fv(group.locProj, 1, GL_FALSE, birdProj.d);
+    glUniform2f(group.locPan, birdPanX, birdPanY);
+    glUniform1f(group.locZoom, birdZoom);
+    glUniform1i(group.locFilter, (int)ResampleFilter::Bilinear);
+    glUniform1f(group.locGrid, 0.0f);
+    if(group.streaming)
+        group.streamTex.draw(quadVAO);
+    else
+        group.minimap.draw(quadVAO);
+
+    float bx0 = birdPanX + visMin.x * birdZoom;
+    float by0 = birdPanY + visMin.y * birdZoom;
+    float bx1 = birdPanX + visMax.x * birdZoom;
+    float by1 = birdPanY + visMax.y * birdZoom;
+
+    // minimap frame and viewport rectangle go out as one overlay batch
+    // in window coordinates
+    glViewport(0, 0, winW, winH);
+    overlay.rect(birdeyeX + bx0, birdeyeY + by0, birdeyeX + bx1, birdeyeY + by1,
+                 Color{0.5f, 0.5f, 1.0f, 0.75f});
+    overlay.frame((float)birdeyeX, (float)birdeyeY,
+                  (float)(birdeyeX + birdeyeW), (float)(birdeyeY + birdeyeH),
+                  1.0f, Color{0.12f, 0.12f, 0.12f, 0.80f});
+    if(showHud)
+        profiler.drawHud(overlay, 12.0f, 12.0f);
+    if(statsView != StatsView::Off)
+        drawStats();
+
+    overlay.flush(proj.d);
+    profiler.end(FrameProfiler::Minimap);
+}
+
+bool Viewer::drawExportTile(float scale, int x, int y, int w, int h){
+    group.tiles.beginFrame();
+    glClearColor(0.12f, 0.12f, 0.12f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // the window's screen space, stretched: the tile is a sub-rectangle
+    // of the window scaled by scale
+    float sx0 = x / scale, sy0 = y / scale;
+    float sx1 = (x + w) / scale, sy1 = (y + h) / scale;
+    Mat4 proj = Mat4::ortho(sx0, sx1, sy0, sy1);
+    float imgW = (float)group.imgW, imgH = (float)group.imgH;
+    Vec2 vis0(clampf((sx0 - pan.x) / zoomLevel, 0.0f, imgW), clampf((sy0 - pan.y) / zoomLevel, 0.0f, imgH));
+    Vec2 vis1(clampf((sx1 - pan.x) / zoomLevel, 0.0f, imgW), clampf((sy1 - pan.y) / zoomLevel, 0.0f, imgH));
+    Vec2 s0, s1;
+    group.toStored(vis0, vis1, s0, s1);
+
+    glUseProgram(group.program);
+    glUniformMatrix4fv(group.locProj, 1, GL_FALSE, proj.d);
+    glUniform2f(group.locPan, pan.x, pan.y);
+    glUniform1f(group.locZoom, zoomLevel);
+    group.setOrientUniform();
+    ResampleFilter f = group.streaming ? ResampleFilter::Bilinear : filter;
+    glUniform1i(group.locFilter, (int)f);
+    glUniform1f(group.locGrid, f == ResampleFilter::Nearest && zoomLevel * scale >= pixelGridZoom ? 0.35f : 0.0f);
+    if(group.streaming){
+        group.streamTex.draw(quadVAO);
+        return true;
+    }
+
+    // tiles at the level for the export's own magnification
+    group.tiles.draw(s0.x, s0.y, s1.x, s1.y, zoomLevel * scale, quadVAO);
+    if(group.tiles.pending())
+        return false;
+
+    if(group.tiles.encoding()){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return false;
+    }
+
+    return true;
+}
+
+bool Viewer::exportView(const std::string& path, int width){
+    if(grid || !group.hasContent()){
+        std::cerr << "Nothing to export\n";
+        return false;
+    }
+
+    makeCurrent();
+    if(width <= 0)
+        width = winW * 4;
+    float scale = (float)width / winW;
+    int height = std::max(1, (int)std::lround(winH * scale));
+
+    auto start = std::chrono::steady_clock::now();
+    std::string err;
+    bool ok = exportTiled(path, width, height, [&](int x, int y, int w, int h){
+        return drawExportTile(scale, x, y, w, h);
+    }, err);
+    if(!ok){
+        std::cerr << err << "\n";
+        return false;
+    }
+
+    double ms = msSince(start);
+    std::cout << "Exported " << width << "x" << height << " to " << path << " in " << ms
+              << " ms (" << (double)width * height / 1e3 / ms << " Mpix/s)\n";
+
+    // the tile cache now holds the export's level; the window redraws
+    needsRedraw = true;
+    return true;
+}
+
+void Viewer::requestStats(const Vec2 &visMin, const Vec2 &visMax){
+    if(!group.image)
+        return;
+
+    // queued regions go in first, and they wait for counts to finish
+    {
+        std::lock_guard<std::mutex> lock(group.regionMutex);
+        if(!group.regions.empty())
+            return;
+    }
+
+    ImageRect r{(int)floor(visMin.x), (int)floor(visMin.y), (int)ceil(visMax.x), (int)ceil(visMax.y)};
+    if(group.image->id == statsImage && r.x0 == statsRect.x0 && r.y0 == statsRect.y0 &&
+       r.x1 == statsRect.x1 && r.y1 == statsRect.y1)
+        return;
+
+    stats.request(group.image, r);
+    statsImage = group.image->id;
+    statsRect = r;
+}
+
+// The results for the panel's current mode, if they belong to the image
+// on show.
+bool Viewer::shownStats(ImageStats& st){
+    bool ok = statsView == StatsView::Whole ? stats.whole(st) : stats.region(st);
+    return ok && group.image && st.source == group.image->id;
+}
+
+// The colour channels' histograms over each other, each scaled to its
+// tallest bin away from the two ends, with the share of pixels clipped at 0 and
+// at 255 as bars on either side (full height at 10%).
+void Viewer::drawStats(){
+    ImageStats st;
+    if(!shownStats(st) || !st.pixels)
+        return;
+
+    static const Color channelColors[3] = {
+        Color{1.0f, 0.3f, 0.3f, 0.55f}, Color{0.3f, 1.0f, 0.3f, 0.55f}, Color{0.35f, 0.5f, 1.0f, 0.55f}
+    };
+    int shown = st.channels == 2 || st.channels == 4 ? st.channels - 1 : st.channels;
+    auto color = [&](int c){
+        return shown == 1 ? Color{0.85f, 0.85f, 0.85f, 0.6f} : channelColors[c];
+    };
+
+    const float w = 256.0f, h = 96.0f, bar = 2.0f;
+    float x0 = 12.0f + bar * shown + 4.0f, y0 = winH - 12.0f - h;
+    overlay.rect(12.0f, y0 - 4.0f, x0 + w + 4.0f + bar * shown, y0 + h + 4.0f,
+                 Color{0.05f, 0.05f, 0.05f, 0.7f});
+
+    for(int c = 0; c < shown; c++){
+        uint64_t peak = 1;
+        for(int v = 1; v < 255; v++)
+            peak = std::max(peak, st.hist[c][v]);
+
+        for(int v = 0; v < 256; v++){
+            float bh = (float)std::min(1.0, (double)st.hist[c][v] / peak) * h;
+            if(bh > 0.0f)
+                overlay.rect(x0 + v, y0, x0 + v + 1.0f, y0 + bh, color(c));
+        }
+
+        float lo = (float)std::min(1.0, 10.0 * st.clippedLow(c) / st.pixels) * h;
+        float hi = (float)std::min(1.0, 10.0 * st.clippedHigh(c) / st.pixels) * h;
+        float lx = x0 - 2.0f - bar * (c + 1), hx = x0 + w + 2.0f + bar * c;
+        if(lo > 0.0f)
+            overlay.rect(lx, y0, lx + bar, y0 + lo, color(c));
+        if(hi > 0.0f)
+            overlay.rect(hx, y0, hx + bar, y0 + hi, color(c));
+    }
+}
+
+// " | R 3-250 avg 118.2 clip 0.0/1.2% ..." for the window title.
+std::string Viewer::statsTitle(){
+    ImageStats st;
+    if(!shownStats(st) || !st.pixels)
+        return std::string();
+
+    const char* names = st.channels <= 2 ? "LA" : "RGBA";
+    std::string t = statsView == StatsView::Whole ? " | image" : " | view";
+    for(int c = 0; c < st.channels; c++){
+        // alpha only when there is any
+        if((st.channels == 2 || st.channels == 4) && c == st.channels - 1 && st.min(c) == 255)
+            continue;
+
+        char buf[96];
+        snprintf(buf, sizeof(buf), " %c %d-%d avg %.1f clip %.1f/%.1f%%", names[c], st.min(c), st.max(c),
+                 st.mean(c), 100.0 * st.clippedLow(c) / st.pixels, 100.0 * st.clippedHigh(c) / st.pixels);
+        t += buf;
+    }
+
+    return t;
+}
+
+void Viewer::drawGrid(){
+    Mat4 proj = Mat4::ortho(0.0f, (float)winW, 0.0f, (float)winH);
+    ContactSheet::Layout l = sheetLayout();
+
+    profiler.begin(FrameProfiler::Main);
+    group.sheet.draw(l, pan.x, pan.y, winH, proj.d, sheetVAO, sheetInstances);
+    profiler.end(FrameProfiler::Main);
+
+    profiler.begin(FrameProfiler::Minimap);
+    int i = group.playlist.index();
+    if(i >= 0 && i < l.count){
+        float x, y;
+        group.sheet.cellOrigin(l, i, x, y);
+        overlay.frame(pan.x + x + 1.0f, pan.y + y + 1.0f, pan.x + x + l.cell - 1.0f,
+                      pan.y + y + l.cell - 1.0f, 2.0f, Color{0.5f, 0.5f, 1.0f, 0.9f});
+    }
+
+    if(showHud)
+        profiler.drawHud(overlay, 12.0f, 12.0f);
+
+    overlay.flush(proj.d);
+    profiler.end(FrameProfiler::Minimap);
+}
+
+bool Viewer::frame(float dt, bool force){
+    makeCurrent();
+
+    if(statsView != StatsView::Off && stats.takeFresh()){
+        needsRedraw = true;
+        lastTitle = 0.0;
+    }
+
+    profiler.begin(FrameProfiler::Spring);
+    sampleCursor();
+    if(!draggingMain && !springSettled()){
+        updateSpring(dt);
+        needsRedraw = true;
+    }
+
+    // a frame drawn in motion is redrawn with the real filter once still
+    if(coarseFrame && !moving())
+        needsRedraw = true;
+    profiler.end(FrameProfiler::Spring);
+
+    // a frame begun but not ended is dropped by the profiler; input
+    // that changed nothing is not waiting for a frame
+    if(!needsRedraw && !force){
+        inputPending = false;
+        return false;
+    }
+
+    needsRedraw = false;
+
+    // tile bookkeeping is per loop iteration, shared by every window
+    if(!group.tilesBegun){
+        group.tiles.beginFrame();
+        group.tilesBegun = true;
+    }
+
+    draw();
+
+    if(win){
+        profiler.begin(FrameProfiler::Swap);
+        glfwSwapBuffers(win);
+        pacer.swapped();
+        profiler.end(FrameProfiler::Swap);
+    }
+    profiler.endFrame();
+    inputShown();
+
+    if(win && (showHud || statsView != StatsView::Off) && glfwGetTime() - lastTitle > 0.5){
+        std::string t = group.title;
+        if(showHud){
+            double cpuMs, gpuMs;
+            profiler.averages(cpuMs, gpuMs);
+            t += " | cpu " + std::to_string(cpuMs).substr(0, 5) +
+                 " ms, gpu " + std::to_string(gpuMs).substr(0, 5) + " ms, " + resampleFilterName(filter);
+            LatencyLog::Summary ls = group.inputLatency.summary();
+            if(ls.count > 0)
+                t += ", input " + std::to_string(ls.p50Ms).substr(0, 5) + " ms";
+        }
+        if(statsView != StatsView::Off)
+            t += statsTitle();
+        glfwSetWindowTitle(win, t.c_str());
+        lastTitle = glfwGetTime();
+    }
+
+    return true;
+}
+
+ViewerGroup::ViewerGroup(const GlimviewOptions& opts){
+    setOptions(opts);
+}
+
+ViewerGroup::~ViewerGroup(){
+    while(!viewers.empty())
+        closeViewer(viewers.back().get());
+
+    stream.setNotify(nullptr);
+    animation.stop();
+}
+
+void ViewerGroup::setOptions(const GlimviewOptions& opts){
+    options = opts;
+    setMipFilter(options.mipFilter);
+    setRawFormat(options.raw);
+    sheet.setBudget(options.tileBudget / 2);
+    diskCache().configure(options.diskCacheDir, options.diskCacheBudget);
+}
+
+void ViewerGroup::setImage(unsigned char* rgba, int w, int h, std::function<void()> release){
+    loadStart = Clock::now();
+    loader.setNotify(glfwPostEmptyEvent);
+    loader.adopt(rgba, w, h, 4, std::move(release));
+}
+
+void ViewerGroup::loadFiles(const std::vector<std::string>& paths){
+    loadStart = Clock::now();
+    animation.setNotify(glfwPostEmptyEvent);
+
+    // the whole list is one animation, with no browsing and no grid
+    if(options.sequenceFps > 0.0){
+        double fps = options.sequenceFps;
+        animation.start([paths, fps](FrameSource& src, std::string& err){
+            return openSequenceSource(paths, fps, src, err);
+        }, options.cacheBudget / 4);
+        return;
+    }
+
+    diskCache().report();
+    playlist.setPrefetch(options.prefetch);
+    playlist.setBudget(options.cacheBudget);
+    playlist.setNotify(glfwPostEmptyEvent);
+    playlist.setFiles(paths);
+    playlist.seek(0);
+    sheet.setFiles(paths);
+}
+
+void ViewerGroup::submitFrame(const unsigned char* rgba, int w, int h){
+    stream.submit(rgba, w, h);
+}
+
+void ViewerGroup::submitFrameYuv(const unsigned char* const planes[3], const int strides[3],
+                                 int w, int h, const FrameFormat& format){
+    stream.submitYuv(planes, strides, w, h, format);
+}
+
+GlimviewStreamStats ViewerGroup::streamStats() const {
+    FrameStream::Stats fs = stream.stats();
+    GlimviewStreamStats st;
+    st.submitted = fs.submitted;
+    st.displayed = fs.displayed;
+    st.dropped = fs.dropped;
+    if(!fs.latencyMs.empty()){
+        std::sort(fs.latencyMs.begin(), fs.latencyMs.end());
+        size_t n = fs.latencyMs.size();
+        st.latencyP50Ms = fs.latencyMs[n / 2];
+        st.latencyP99Ms = fs.latencyMs[std::min(n - 1, n * 99 / 100)];
+        st.latencyMaxMs = fs.latencyMs.back();
+    }
+
+    return st;
+}
+
+void ViewerGroup::updateRegion(const unsigned char* rgba, int x, int y, int w, int h){
+    if(w <= 0 || h <= 0)
+        return;
+
+    RegionUpdate u;
+    u.pixels.assign(rgba, rgba + (size_t)w * h * 4);
+    u.x = x;
+    u.y = y;
+    u.w = w;
+    u.h = h;
+    {
+        std::lock_guard<std::mutex> lock(regionMutex);
+        regions.push_back(std::move(u));
+    }
+
+    if(void (*fn)() = notify.load())
+        fn();
+}
+
+// GL objects every window draws with. Needs any context of the group
+// current.
+void ViewerGroup::initShared(){
+    float vertices[] = {
+        0.0f, 0.0f,
+        1.0f, 0.0f,
+        1.0f, 1.0f,
+        0.0f, 1.0f
+    };
+
+    unsigned int indices[] = {0, 1, 2, 2, 3, 0};
+    glGenBuffers(1, &quadVBO);
+    glGenBuffers(1, &quadEBO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vs_src);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, resampleFragmentShader);
+    program = linkProgram(vs, fs);
+
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    locProj = glGetUniformLocation(program, "uProj");
+    locPan = glGetUniformLocation(program, "uPan");
+    locZoom = glGetUniformLocation(program, "uZoom");
+    locFilter = glGetUniformLocation(program, "uFilter");
+    locGrid = glGetUniformLocation(program, "uGrid");
+    locOrient = glGetUniformLocation(program, "uOrient");
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uTex"), 0);
+
+    tiles.init(program);
+    minimap.init(program);
+    streamTex.init(program);
+    tiles.setBudget(options.tileBudget);
+    tiles.setCompression(options.compression);
+    tiles.setNotify(glfwPostEmptyEvent);
+    sheet.init();
+    sheet.setNotify(glfwPostEmptyEvent);
+    sharedReady = true;
+}
+
+void ViewerGroup::destroyShared(){
+    glDeleteProgram(program);
+    glDeleteBuffers(1, &quadVBO);
+    glDeleteBuffers(1, &quadEBO);
+    tiles.destroy();
+    minimap.destroy();
+    streamTex.destroy();
+    sheet.destroy();
+    streaming = false;
+    image.reset();
+    imgW = imgH = 0;
+    sharedReady = false;
+}
+
+Viewer* ViewerGroup::openWindow(int width, int height, GLFWmonitor* monitor){
+    if(!glfwInit()){
+        std::cerr<<"Failed to initialize GLFW\n";
+        return nullptr;
+    }
+
+    // producers may have been submitting before the window existed
+    stream.setNotify(glfwPostEmptyEvent);
+    notify = glfwPostEmptyEvent;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    // every later window shares objects with the first
+    GLFWwindow* share = viewers.empty() ? nullptr : viewers.front()->win;
+    GLFWwindow* window = glfwCreateWindow(width, height, title.c_str(), NULL, share);
+    if(!window){
+        std::cerr<<"Failed to create window\n";
+        return nullptr;
+    }
+
+    glfwMakeContextCurrent(window);
+    if(!share && !gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)){
+        std::cerr<<"Failed to init GLAD\n";
+        glfwDestroyWindow(window);
+        return nullptr;
+    }
+
+    // one blocked swap paces the loop, not one per window
+    glfwSwapInterval(share ? 0 : options.swapInterval);
+
+    if(monitor){
+        int mx, my, mw, mh;
+        glfwGetMonitorWorkarea(monitor, &mx, &my, &mw, &mh);
+        glfwSetWindowPos(window, mx + std::max(0, (mw - width) / 2), my + std::max(0, (mh - height) / 2));
+    }
+
+    int fbW, fbH;
+    glfwGetFramebufferSize(window, &fbW, &fbH);
+    viewers.emplace_back(new Viewer(*this, window, fbW, fbH));
+    Viewer* v = viewers.back().get();
+
+    glfwSetWindowUserPointer(window, v);
+    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    glfwSetCursorPosCallback(window, cursorCallback);
+    glfwSetScrollCallback(window, scrollCallback);
+    glfwSetKeyCallback(window, keyCallback);
+    glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+
+    if(!sharedReady)
+        initShared();
+    v->initGL(viewers.size() == 1);
+    v->fitView();
+    return v;
+}
+
+void ViewerGroup::closeViewer(Viewer* v){
+    v->makeCurrent();
+    if(viewers.size() == 1){
+        printStats();
+        destroyShared();
+    }
+    v->destroyGL();
+
+    for(auto it = viewers.begin(); it != viewers.end(); ++it)
+        if(it->get() == v){
+            viewers.erase(it);
+            break;
+        }
+}
+
+void ViewerGroup::redrawAll(){
+    for(auto &v : viewers)
+        v->needsRedraw = true;
+}
+
+// Thumbnails for the grids: finished ones go into the atlas, then the
+// rows in and around every grid on screen are queued.
+void ViewerGroup::updateSheet(){
+    if(sheet.upload())
+        for(auto &v : viewers)
+            if(v->grid)
+                v->needsRedraw = true;
+
+    sheet.beginFrame();
+    for(auto &v : viewers)
+        if(v->grid)
+            sheet.want(v->sheetLayout(), v->pan.y, v->winH);
+    sheet.schedule();
+}
+
+void ViewerGroup::attachImage(std::shared_ptr<Image> img){
+    image = std::move(img);
+    userOrient = Orientation();
+    imgW = image->orientation.displayW(image->w, image->h);
+    imgH = image->orientation.displayH(image->w, image->h);
+    streaming = false;
+    tiles.setImage(image);
+    minimap.setImage(image);
+    for(auto &v : viewers){
+        v->stats.invalidate();
+        v->statsImage = 0;
+        v->fitView();
+    }
+
+    if(remoteClient >= 0 && !remoteAttached){
+        remoteAttached = true;
+        remoteUploads = tiles.stats().tilesUploaded;
+    }
+}
+
+// A live frame replaces whatever still image was shown; the views are
+// only reset when the stream starts or changes size.
+void ViewerGroup::attachFrame(const FrameStream::Frame& f){
+    animation.stop();
+    if(streamTex.upload(f))
+        showStream(f.w, f.h);
+}
+
+// Live and animation frames go through the stream texture; a still
+// image is dropped for them.
+void ViewerGroup::showStream(int w, int h){
+    redrawAll();
+    if(streaming && w == imgW && h == imgH)
+        return;
+
+    image.reset();
+    tiles.setImage(nullptr);
+    minimap.setImage(nullptr);
+    imgW = w;
+    imgH = h;
+    streaming = true;
+    for(auto &v : viewers){
+        v->stats.invalidate();
+        v->statsImage = 0;
+        v->fitView();
+    }
+
+    remoteAttached = remoteClient >= 0;
+}
+
+// The still first frame from the playlist is shown at once; the player
+// takes over once its first frame is decoded. Files with one frame
+// stay as they are.
+void ViewerGroup::startAnimation(const std::string& path){
+    animation.stop();
+    std::string ext = path.size() >= 4 ? path.substr(path.size() - 4) : std::string();
+    for(char &c : ext)
+        c = (char)tolower(c);
+    if(ext != ".gif")
+        return;
+
+    animation.start([path](FrameSource& src, std::string& err){
+        return openGifSource(path, src, err);
+    }, options.cacheBudget / 4);
+}
+
+// The next frame goes into the back texture as soon as it is decoded;
+// the flip waits for its time.
+void ViewerGroup::pollAnimation(){
+    if(!animation.active())
+        return;
+
+    auto stage = [this](const FrameStream::Frame& f){ return streamTex.stage(f); };
+    if(animation.update(Clock::now(), stage)){
+        streamTex.flip();
+        showStream(streamTex.width(), streamTex.height());
+    }
+}
+
+// The image's own orientation followed by the user's turns.
+Orientation ViewerGroup::orientation() const {
+    return image && !streaming ? image->orientation.then(userOrient) : Orientation();
+}
+
+void ViewerGroup::setOrientUniform(){
+    float m[9];
+    Orientation o = orientation();
+    o.matrix(image && !streaming ? image->w : imgW, image && !streaming ? image->h : imgH, m);
+    glUniformMatrix3fv(locOrient, 1, GL_FALSE, m);
+}
+
+void ViewerGroup::toStored(const Vec2 &dmin, const Vec2 &dmax, Vec2 &smin, Vec2 &smax) const {
+    if(!image || streaming){
+        smin = dmin;
+        smax = dmax;
+        return;
+    }
+
+    Orientation o = orientation();
+    float ax, ay, bx, by;
+    o.toStored(dmin.x, dmin.y, image->w, image->h, ax, ay);
+    o.toStored(dmax.x, dmax.y, image->w, image->h, bx, by);
+    smin = Vec2(fmin(ax, bx), fmin(ay, by));
+    smax = Vec2(fmax(ax, bx), fmax(ay, by));
+}
+
+void ViewerGroup::reorient(const Orientation& o){
+    if(!image || streaming)
+        return;
+
+    userOrient = userOrient.then(o);
+    Orientation d = orientation();
+    imgW = d.displayW(image->w, image->h);
+    imgH = d.displayH(image->w, image->h);
+    for(auto &v : viewers){
+        v->statsImage = 0;
+        v->fitView();
+    }
+}
+
+// Writes queued regions into the image and refreshes the tiles and the
+// minimap texels they touch. Regions outside the image are clipped.
+void ViewerGroup::applyRegions(){
+    // a count reads level 0 in place; the regions stay queued until it
+    // is done, and its end wakes the loop
+    for(auto &v : viewers)
+        if(v->stats.busy())
+            return;
+
+    std::vector<RegionUpdate> pending;
+    {
+        std::lock_guard<std::mutex> lock(regionMutex);
+        if(streaming)
+            regions.clear();
+        if(regions.empty() || !image)
+            return;
+
+        pending.swap(regions);
+    }
+
+    // regions come as RGBA rows bottom to top, like the whole image
+    // handed to glimviewUpdateImage; they are packed to the image's
+    // channels and flipped for one stored top row first
+    int n = image->channels;
+    std::vector<unsigned char> packed;
+    for(const RegionUpdate& u : pending){
+        int x0 = std::max(u.x, 0), y0 = std::max(u.y, 0);
+        int x1 = std::min(u.x + u.w, image->w), y1 = std::min(u.y + u.h, image->h);
+        if(x1 <= x0 || y1 <= y0)
+            continue;
+
+        int w = x1 - x0, h = y1 - y0;
+        size_t stride = (size_t)w * n;
+        packed.resize(stride * h);
+        for(int r = 0; r < h; r++){
+            const unsigned char* src = u.pixels.data() + ((size_t)(y0 - u.y + r) * u.w + (x0 - u.x)) * 4;
+            int dr = image->topFirst ? h - 1 - r : r;
+            packFromRgba(src, n, image->bgr, packed.data() + dr * stride, w);
+        }
+
+        int sy = image->topFirst ? image->h - y1 : y0;
+        std::vector<ImageRect> rects = ::updateRegion(*image, packed.data(), stride, x0, sy, w, h);
+        tiles.invalidate(rects);
+        minimap.update(*image, rects.back());
+    }
+
+    for(auto &v : viewers){
+        v->stats.invalidate();
+        v->statsImage = 0;
+    }
+
+    redrawAll();
+}
+
+// A remote request starts over like a new invocation would, with the
+// grid closed; the answer waits for the first frame showing the result.
+// An older request still waiting is told it was replaced.
+void ViewerGroup::handleRemote(RemoteRequest& req){
+    if(remoteClient >= 0)
+        remote.reply(remoteClient, "error replaced by a later request");
+
+    remoteClient = req.client;
+    remoteStart = Clock::now();
+    remoteAttached = false;
+    attachMs = firstPixelMs = fullImageMs = -1.0;
+    failedIndex = -1;
+    for(auto &v : viewers)
+        v->setGrid(false);
+
+    if(req.pixels)
+        setImage(req.pixels, req.w, req.h, std::move(req.release));
+    else
+        loadFiles(req.paths);
+}
+
+// Picks up whatever the loader or the playlist finished. Returns false
+// when the only image there is failed to load.
+bool ViewerGroup::pollImages(){
+    bool ok = true;
+    RemoteRequest req;
+    while(remote.poll(req))
+        handleRemote(req);
+
+    if(std::shared_ptr<Image> img = loader.poll()){
+        animation.stop();
+        attachImage(img);
+    } else if(!image && loader.failed()){
+        std::cerr << loader.error() << "\n";
+        ok = false;
+    }
+
+    if(const FrameStream::Frame* f = stream.acquire())
+        attachFrame(*f);
+
+    if(std::shared_ptr<Image> img = playlist.poll()){
+        attachImage(img);
+        startAnimation(playlist.path());
+        switched = true;
+        title = playlist.path() + " (" + std::to_string(playlist.index() + 1) +
+                "/" + std::to_string(playlist.size()) + ")";
+        titleChanged = true;
+    } else if(playlist.failed() && failedIndex != playlist.index()){
+        failedIndex = playlist.index();
+        std::cerr << playlist.error() << "\n";
+        if(remoteClient >= 0){
+            remote.reply(remoteClient, "error " + playlist.error());
+            remoteClient = -1;
+        }
+        if(playlist.size() == 1 && !remote.listening())
+            ok = false;
+    }
+
+    pollAnimation();
+    applyRegions();
+    updateSheet();
+
+    if(image && attachMs < 0.0)
+        attachMs = msSince(loadStart);
+
+    return ok;
+}
+
+// Bookkeeping once a frame is presented.
+void ViewerGroup::framePresented(){
+    stream.presented();
+    if(switched){
+        playlist.displayed();
+        switched = false;
+    }
+
+    if(remoteAttached && (streaming || tiles.stats().tilesUploaded > remoteUploads)){
+        double ms = msSince(remoteStart);
+        remoteLatency.add(ms);
+        remote.reply(remoteClient, "ok " + std::to_string(ms));
+        remoteClient = -1;
+        remoteAttached = false;
+    }
+
+    if(!image)
+        return;
+
+    if(firstPixelMs < 0.0 && tiles.residentBytes() > 0)
+        firstPixelMs = msSince(loadStart);
+
+    if(fullImageMs < 0.0 && !tiles.pending() && !tiles.encoding())
+        fullImageMs = msSince(loadStart);
+}
+
+void ViewerGroup::printStats(){
+    std::cout << "Frames: " << framesRendered << " rendered, " << framesSkipped << " skipped\n";
+
+    if(firstPixelMs >= 0.0)
+        std::cout << "Time to first pixel: " << firstPixelMs << " ms\n";
+
+    if(fullImageMs >= 0.0)
+        std::cout << "Time to full image: " << fullImageMs << " ms\n";
+
+    if(tiles.compression() != TextureCompression::None){
+        TiledImage::Stats ts = tiles.stats();
+        std::cout << "Tile compression: " << textureCompressionName(tiles.compression()) << ", "
+                  << ts.tilesEncoded << " tiles encoded in " << ts.encodeMs << " ms CPU, "
+                  << (tiles.residentBytes() >> 20) << " MB VRAM instead of "
+                  << (tiles.uncompressedBytes() >> 20) << " MB\n";
+    }
+
+    if(stream.active()){
+        GlimviewStreamStats st = streamStats();
+        std::cout << "Stream: " << st.submitted << " frames submitted, " << st.displayed
+                  << " displayed, " << st.dropped << " dropped; latency " << st.latencyP50Ms
+                  << " ms p50, " << st.latencyP99Ms << " ms p99, " << st.latencyMaxMs << " ms max; "
+                  << (streamTex.bytesUploaded() >> 20) << " MB uploaded\n";
+    }
+
+    AnimationPlayer::Stats as = animation.stats();
+    if(as.shown > 0)
+        std::cout << "Animation: " << as.shown << " frames shown, " << as.late << " late (max "
+                  << as.maxLateMs << " ms), " << as.dropped << " dropped, " << as.loops
+                  << " loops; decode " << (as.decoded ? as.decodeMs / as.decoded : 0.0)
+                  << " ms per frame, " << as.ringFrames << " frames decoded ahead\n";
+
+    LatencyLog::Summary rs = remoteLatency.summary();
+    if(rs.count > 0)
+        std::cout << "Remote requests: " << rs.count << ", request to first frame " << rs.p50Ms
+                  << " ms p50, " << rs.p99Ms << " ms p99, " << rs.maxMs << " ms max\n";
+
+    LatencyLog::Summary ls = inputLatency.summary();
+    if(ls.count > 0)
+        std::cout << "Input to swap: " << ls.p50Ms << " ms p50, " << ls.p90Ms << " ms p90, "
+                  << ls.p99Ms << " ms p99, " << ls.maxMs << " ms max over " << ls.count
+                  << " frames (swap interval " << options.swapInterval << ", pacing "
+                  << framePacingName(options.pacing) << (options.lateInput ? ", late input" : "")
+                  << ")\n";
+
+    ContactSheet::Stats cs = sheet.stats();
+    if(cs.decoded + cs.failed > 0)
+        std::cout << "Contact sheet: " << cs.decoded << " thumbnails decoded in " << cs.decodeMs
+                  << " ms CPU, " << cs.uploads << " uploaded, " << cs.evictions << " evicted\n";
+
+    DiskCache::Stats ds = diskCache().stats();
+    if(ds.hits + ds.misses > 0)
+        std::cout << "Disk cache: " << ds.hits << " hits, " << ds.misses << " misses\n";
+
+    Playlist::Stats ps = playlist.stats();
+    if(ps.hits + ps.misses > 1){
+        double total = 0.0, worst = 0.0;
+        for(double ms : ps.switchMs){
+            total += ms;
+            worst = fmax(worst, ms);
+        }
+
+        std::cout << "Prefetch cache: " << ps.hits << " hits, " << ps.misses << " misses ("
+                  << 100.0 * ps.hits / (ps.hits + ps.misses) << "% hit rate)\n";
+        if(!ps.switchMs.empty())
+            std::cout << "Image switch: " << total / ps.switchMs.size() << " ms avg, "
+                      << worst << " ms worst over " << ps.switchMs.size() << " switches\n";
+    }
+}
+
+int ViewerGroup::run(){
+    double lastTime = glfwGetTime();
+    int ret = 0;
+
+    while(!viewers.empty()){
+        // nothing moving and nothing new to show: block until an input
+        // event arrives or a worker posts a finished image. While dragging
+        // the spring is off and only cursor events move the image.
+        bool busy = tiles.pending() || sheet.pending();
+        for(auto &v : viewers)
+            busy = busy || v->busy();
+        if(!busy){
+            // an animation frame waiting for its time wakes the loop too
+            double wait = animation.secondsToNext(Clock::now());
+            if(wait >= 0.0)
+                glfwWaitEventsTimeout(wait);
+            else
+                glfwWaitEvents();
+            lastTime = glfwGetTime();
+        }
+
+        for(auto &v : viewers)
+            v->beginFrame();
+        glfwPollEvents();
+
+        double now = glfwGetTime();
+        double dt = now - lastTime;
+        lastTime = now;
+        if(dt > 0.05)
+            dt = 0.05;
+
+        // the windows are up before decoding finishes; the image is
+        // attached as soon as the loader or the playlist hands it over.
+        // Uploads go through the first context and are flushed so the
+        // others see them.
+        viewers.front()->makeCurrent();
+        if(!pollImages()){
+            for(auto &v : viewers)
+                glfwSetWindowShouldClose(v->win, 1);
+            ret = 1;
+        }
+        glFlush();
+
+        for(auto &v : viewers){
+            if(titleChanged)
+                glfwSetWindowTitle(v->win, title.c_str());
+            v->profiler.end(FrameProfiler::Events);
+        }
+        titleChanged = false;
+
+        // the shared objects live on in whichever windows are left
+        for(size_t i = 0; i < viewers.size();){
+            if(glfwWindowShouldClose(viewers[i]->win))
+                closeViewer(viewers[i].get());
+            else
+                i++;
+        }
+
+        if(viewers.empty())
+            break;
+
+        if(exportRequested){
+            Viewer* v = exportRequested;
+            exportRequested = nullptr;
+            v->exportView(options.exportPath, options.exportWidth);
+        }
+
+        if(openRequested){
+            openRequested = false;
+            int w, h;
+            glfwGetWindowSize(viewers.front()->win, &w, &h);
+            openWindow(w, h);
+        }
+
+        bool pending = tiles.pending();
+        bool drew = false;
+        tilesBegun = false;
+        for(auto &v : viewers)
+            drew = v->frame((float)dt, pending) || drew;
+
+        if(drew){
+            framesRendered++;
+            framePresented();
+        } else {
+            framesSkipped++;
+        }
+    }
+
+    // later clients start a viewer of their own
+    remote.stop();
+    stream.setNotify(nullptr);
+    notify = nullptr;
+    return ret;
+}
+
+bool ViewerGroup::serve(const std::string& socketPath){
+    std::string err;
+    remote.setNotify(glfwPostEmptyEvent);
+    if(!remote.listen(socketPath.empty() ? defaultSocketPath() : socketPath, err)){
+        std::cerr << err << "\n";
+        return false;
+    }
+    return true;
+}
+
+Viewer* ViewerGroup::openHeadless(int width, int height){
+    viewers.emplace_back(new Viewer(*this, nullptr, width, height));
+    Viewer* v = viewers.back().get();
+    if(!sharedReady)
+        initShared();
+    v->initGL(viewers.size() == 1);
+    v->updateBirdeyeDims();
+    return v;
+}
+
+bool ViewerGroup::headlessFrame(double dt){
+    for(auto &v : viewers)
+        v->beginFrame();
+
+    bool ok = pollImages();
+    for(auto &v : viewers)
+        v->profiler.end(FrameProfiler::Events);
+
+    tilesBegun = false;
+    for(auto &v : viewers)
+        v->frame((float)dt, true);
+
+    framePresented();
+    framesRendered++;
+    return ok;
+}
+
+void ViewerGroup::closeHeadless(){
+    for(auto &v : viewers)
+        v->destroyGL();
+    viewers.clear();
+
+    destroyShared();
+    attachMs = firstPixelMs = fullImageMs = -1.0;
+}
+
+bool ViewerGroup::exportView(const std::string& path, int width){
+    return !viewers.empty() && viewers.front()->exportView(path, width);
+}
+
+GlimviewHeadlessStats ViewerGroup::headlessStats() const {
+    GlimviewHeadlessStats st;
+    st.hasImage = image != nullptr;
+    st.settled = viewers.empty() || (viewers.front()->springSettled() && !viewers.front()->draggingMain);
+    st.tilesPending = tiles.pending() || tiles.encoding();
+    st.attachMs = attachMs;
+    st.firstPixelMs = firstPixelMs;
+    st.fullImageMs = fullImageMs;
+    TiledImage::Stats ts = tiles.stats();
+    st.tilesUploaded = ts.tilesUploaded;
+    st.bytesUploaded = ts.bytesUploaded;
+    st.uploadMs = ts.uploadMs;
+    return st;
+}
@@ -0,0 +1,321 @@
+/*    Copyright (c) 2025 Sushant kr. Ray
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+ */
+
+#ifndef VIEWER_H
+#define VIEWER_H
+
+#include "animation.hpp"
+#include "contactsheet.hpp"
+#include "glimview.hpp"
+#include "glimviewoptions.hpp"
+#include "imagestats.hpp"
+#include "loader.hpp"
+#include "minimap.hpp"
+#include "overlay.hpp"
+#include "playlist.hpp"
+#include "profiler.hpp"
+#include "remote.hpp"
+#include "stream.hpp"
+#include "tiledexport.hpp"
+#include "tiledimage.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ViewerGroup;
+
+struct Vec2{
+    float x, y;
+    Vec2(float _x = 0, float _y = 0):
+        x(_x), y(_y) {}
+};
+
+// One view of a ViewerGroup's image: a window, or headless whatever
+// framebuffer the caller has bound, with its own pan, zoom, minimap
+// placement and frame timing. Everything it draws with that GL can
+// share lives in the group; only the objects GL cannot share between
+// contexts (the quad VAO, the overlay's VAO, timer queries) are its own.
+class Viewer{
+public:
+    ~Viewer();
+
+    GLFWwindow* window() const { return win; }
+
+    // Input in window coordinates (origin at the top left, like GLFW).
+    // The window callbacks land here; headless drivers call them directly.
+    void mouseButton(int button, int action, double x, double y);
+    void cursor(double x, double y);
+    void scroll(double x, double y, double yoffset);
+    void key(int key, int action, int mods);
+    void resize(int width, int height);
+    void redraw() { needsRedraw = true; }
+
+    // The image as shown now, scaled to width pixels across, written to
+    // a .tga or .ppm file; see glimviewExport. Overlays are left out.
+    bool exportView(const std::string& path, int width);
+
+private:
+    friend class ViewerGroup;
+
+    Viewer(ViewerGroup& group, GLFWwindow* window, int width, int height);
+    Viewer(const Viewer&) = delete;
+    Viewer& operator=(const Viewer&) = delete;
+
+    void initGL(bool primary);
+    void destroyGL();
+    void makeCurrent() const;
+
+    // Centres the group's image after it changed.
+    void fitView();
+    // Something moved or changed; the group keeps drawing while true.
+    bool busy() const;
+    void beginFrame();
+    // Draws and presents if anything changed; false if the frame was skipped.
+    bool frame(float dt, bool tilesPending);
+    void draw();
+
+    Vec2 toScreen(double x, double y) const;
+    // What pan moves around: the image, or the contact sheet in grid mode.
+    float contentW() const;
+    float contentH() const;
+    Vec2 clampedPan(const Vec2 &p, float z) const;
+    Vec2 screenToImage(const Vec2 &s) const;
+    void centerImage(const Vec2 &imgPt);
+    void centerFromMinimap(const Vec2 &s);
+    void zoomAt(const Vec2 &s, double yoffset);
+    void updateBirdeyeDims();
+    void updateSpring(float dt);
+    bool springSettled() const;
+    // Input latency: the oldest input not shown yet is stamped, and the
+    // frame that shows it records the time to its swap.
+    void inputEvent();
+    void inputShown();
+    // With late input, drags follow the cursor position read just before
+    // drawing instead of the queued motion events.
+    void moveCursor(const Vec2 &cur);
+    void sampleCursor();
+    // Dragged or springing; drawn with the cheap filter meanwhile.
+    bool moving() const;
+
+    // Contact sheet of the playlist in place of the image. Grid mode
+    // reuses pan and the spring at zoom 1 over the whole sheet.
+    void setGrid(bool on);
+    ContactSheet::Layout sheetLayout() const;
+    void revealCell(int i);
+    void gridKey(int key);
+    void zoomGrid(const Vec2 &s, double yoffset);
+    void drawGrid();
+    // One export tile: output pixels [x, x + w) x [y, y + h) of a view
+    // scaled by scale.
+    bool drawExportTile(float scale, int x, int y, int w, int h);
+
+    // Histogram panel and title readout for the visible region or the
+    // whole image, counted in the background.
+    enum class StatsView{ Off, Visible, Whole };
+    void requestStats(const Vec2 &visMin, const Vec2 &visMax);
+    bool shownStats(ImageStats& st);
+    void drawStats();
+    std::string statsTitle();
+
+    ViewerGroup& group;
+    GLFWwindow* win = nullptr;
+    int winW, winH;
+
+    Vec2 pan, targetPan, panVel;
+    float zoomLevel = 1.0f;
+
+    // set whenever something on screen changed; the event loop sleeps in
+    // glfwWaitEvents while it is clear and the spring has settled
+    bool needsRedraw = true;
+
+    bool leftDown = false;
+    bool draggingMain = false;
+    bool draggingBird = false;
+    double lastMouseX = 0, lastMouseY = 0;
+
+    bool cursorMoved = false;       // late input: a drag moved since the last sample
+    bool inputPending = false;
+    std::chrono::steady_clock::time_point inputTime;
+    FramePacer pacer;
+
+    int birdeyeW = 220, birdeyeH = 0;
+    int birdeyeX = 0, birdeyeY = 0;
+    int birdeyeMargin = 12;
+
+    bool grid = false;
+    float cellSize = 160.0f;
+    Vec2 imagePan;              // image view to return to from the grid
+    float imageZoom = 1.0f;
+    bool refitImage = false;    // the image changed while in the grid
+    double pressX = 0, pressY = 0;
+
+    GLuint quadVAO = 0;
+    GLuint sheetVAO = 0, sheetInstances = 0;
+    Overlay overlay;
+    FrameProfiler profiler;
+    bool profiling = false;         // profiler.beginFrame() called this frame
+    bool showHud = false;
+    double lastTitle = 0.0;
+
+    ResampleFilter filter = ResampleFilter::Bicubic;
+    bool coarseFrame = false;       // last frame fell back to bilinear while moving
+
+    StatsView statsView = StatsView::Off;
+    StatsEngine stats;
+    ImageRect statsRect;
+    uint64_t statsImage = 0;        // Image::id the last request was for
+};
+
+// Windows showing the same image. All of them share one GL context
+// group, so every tile, the minimap thumbnail and live stream frames are
+// uploaded once and drawn in as many windows (or monitors) as are open,
+// with no duplicate VRAM. A single event loop drives all the windows.
+//
+// The application calls glfwInit() implicitly through the first
+// openWindow() and glfwTerminate() itself once it is done with GLFW.
+class ViewerGroup{
+public:
+    explicit ViewerGroup(const GlimviewOptions& opts = GlimviewOptions());
+    ~ViewerGroup();
+
+    // Takes effect for windows opened from now on. The mip filter and
+    // the disk cache are process-wide.
+    void setOptions(const GlimviewOptions& opts);
+    const GlimviewOptions& getOptions() const { return options; }
+
+    // Content. All return at once (decoding and mip building run on
+    // worker threads) and may be called before any window exists.
+    void loadFiles(const std::vector<std::string>& paths);
+    void setImage(unsigned char* rgba, int w, int h, std::function<void()> release);
+    // See glimviewSubmitFrame / glimviewUpdateRegion; safe from any thread.
+    void submitFrame(const unsigned char* rgba, int w, int h);
+    void submitFrameYuv(const unsigned char* const planes[3], const int strides[3], int w, int h,
+                        const FrameFormat& format);
+    void updateRegion(const unsigned char* rgba, int x, int y, int w, int h);
+    GlimviewStreamStats streamStats() const;
+
+    // Opens a window sharing the group's GL objects, placed on monitor
+    // if one is given. Returns nullptr if GLFW or the context fails.
+    Viewer* openWindow(int width, int height, GLFWmonitor* monitor = nullptr);
+    // Event loop until every window is closed. Returns 1 if the only
+    // image failed to load.
+    int run();
+
+    // Also takes files and images from other processes on a Unix socket
+    // (the default one for an empty path) until run() ends; see
+    // remote.hpp. A failed remote load then never ends the loop.
+    bool serve(const std::string& socketPath);
+
+    // Headless view drawing into the caller's current GL 3.3 context and
+    // bound framebuffer; see glimview.hpp.
+    Viewer* openHeadless(int width, int height);
+    bool headlessFrame(double dt);
+    void closeHeadless();
+    GlimviewHeadlessStats headlessStats() const;
+
+    void printStats();
+    // Exports the first view; see glimviewExport.
+    bool exportView(const std::string& path, int width);
+
+private:
+    friend class Viewer;
+    typedef std::chrono::steady_clock Clock;
+
+    // regions handed in by updateRegion, applied on the render thread
+    struct RegionUpdate{
+        std::vector<unsigned char> pixels;
+        int x, y, w, h;
+    };
+
+    bool hasContent() const { return image || streaming; }
+    void initShared();
+    void destroyShared();
+    void closeViewer(Viewer* v);
+    bool pollImages();
+    void attachImage(std::shared_ptr<Image> img);
+    void attachFrame(const FrameStream::Frame& f);
+    void showStream(int w, int h);
+    void startAnimation(const std::string& path);
+    void pollAnimation();
+    void handleRemote(RemoteRequest& req);
+    void applyRegions();
+    void framePresented();
+    void redrawAll();
+    void updateSheet();
+    // The image's orientation followed by the user's turns, the uOrient
+    // uniform for it, and a displayed rectangle in stored pixels.
+    Orientation orientation() const;
+    void setOrientUniform();
+    void toStored(const Vec2 &dmin, const Vec2 &dmax, Vec2 &smin, Vec2 &smax) const;
+    void reorient(const Orientation& o);
+
+    GlimviewOptions options;
+    std::vector<std::unique_ptr<Viewer>> viewers;
+    bool sharedReady = false;
+    bool tilesBegun = false;        // tiles.beginFrame() done this iteration
+    bool openRequested = false;
+    Viewer* exportRequested = nullptr;  // Ctrl+E, done between frames
+
+    ImageLoader loader;
+    Playlist playlist;
+    FrameStream stream;
+    AnimationPlayer animation;
+    RemoteServer remote;
+    std::mutex regionMutex;
+    std::vector<RegionUpdate> regions;
+    std::atomic<void (*)()> notify{nullptr};
+    Clock::time_point loadStart;
+
+    std::shared_ptr<Image> image;
+    int imgW = 0, imgH = 0;         // as displayed, turns applied
+    Orientation userOrient;         // R / M on top of the image's own
+    bool streaming = false;     // showing live or animation frames instead of a still image
+    TiledImage tiles;
+    Minimap minimap;
+    StreamTexture streamTex;
+    ContactSheet sheet;
+
+    GLuint quadVBO = 0, quadEBO = 0;
+    GLuint program = 0;
+    GLint locProj = -1, locPan = -1, locZoom = -1;
+    GLint locFilter = -1, locGrid = -1, locOrient = -1;
+
+    // per-load bookkeeping
+    std::string title = "Image Viewer";
+    bool titleChanged = false;
+    bool switched = false;
+    int failedIndex = -1;
+    double attachMs = -1.0, firstPixelMs = -1.0, fullImageMs = -1.0;
+    // the remote request waiting for its image to reach the screen
+    int remoteClient = -1;
+    Clock::time_point remoteStart;
+    bool remoteAttached = false;
+    size_t remoteUploads = 0;       // tiles uploaded before its image came
+    LatencyLog remoteLatency;
+    unsigned long framesRendered = 0, framesSkipped = 0;
+    LatencyLog inputLatency;
+};
+
+#endif // VIEWER_H